@@ -0,0 +1,152 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "../utils/helpers.h"
+#include "./auction.h"
+
+template <class T>
+arena_unordered_map<index_t, index_t>
+auction_assignment(const matrix<T>& m, unsigned nb_threads, arena& memory) {
+  constexpr index_t UNASSIGNED = std::numeric_limits<index_t>::max();
+
+  const index_t n = m.size();
+  arena_unordered_map<index_t, index_t> assignment(memory);
+  if (n < 2) {
+    if (n == 1) {
+      assignment.emplace(0, 0);
+    }
+    return assignment;
+  }
+
+  // Start with epsilon in the range of costs, diagonal values aside
+  // as they are never worth assigning.
+  T max_cost = 0;
+  for (index_t i = 0; i < n; ++i) {
+    for (index_t j = 0; j < n; ++j) {
+      if (i != j) {
+        max_cost = std::max(max_cost, m[i][j]);
+      }
+    }
+  }
+  const double final_epsilon = 1.0 / (n + 1);
+  double epsilon =
+    std::max(static_cast<double>(max_cost) / AUCTION_SCALING_FACTOR,
+             final_epsilon);
+
+  // Bidders are rows, objects are columns. Bidding for object j
+  // yields a value of -m[i][j] - prices[j].
+  std::vector<double> prices(n, 0);
+  std::vector<index_t> object_of(n);
+  std::vector<index_t> owner_of(n);
+
+  std::vector<index_t> unassigned;
+  std::vector<index_t> bid_objects;
+  std::vector<double> bid_values;
+  std::vector<double> best_bids(n);
+  std::vector<index_t> best_bidders(n, UNASSIGNED);
+  std::vector<index_t> bid_for_objects;
+  std::vector<index_t> still_unassigned;
+
+  while (true) {
+    // Assignment is restarted at each scaling phase, prices are kept.
+    std::fill(object_of.begin(), object_of.end(), UNASSIGNED);
+    std::fill(owner_of.begin(), owner_of.end(), UNASSIGNED);
+    unassigned.resize(n);
+    for (index_t i = 0; i < n; ++i) {
+      unassigned[i] = i;
+    }
+
+    while (!unassigned.empty()) {
+      // Bidding phase: each unassigned bidder bids for its best
+      // object, raising its price by the difference with the second
+      // best value plus epsilon.
+      bid_objects.resize(unassigned.size());
+      bid_values.resize(unassigned.size());
+
+      auto bid = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) {
+          const index_t i = unassigned[k];
+          index_t best_j = 0;
+          double best_value = std::numeric_limits<double>::lowest();
+          double second_value = std::numeric_limits<double>::lowest();
+          for (index_t j = 0; j < n; ++j) {
+            const double value = -static_cast<double>(m[i][j]) - prices[j];
+            if (value > best_value) {
+              second_value = best_value;
+              best_value = value;
+              best_j = j;
+            } else if (value > second_value) {
+              second_value = value;
+            }
+          }
+          bid_objects[k] = best_j;
+          bid_values[k] = prices[best_j] + best_value - second_value + epsilon;
+        }
+      };
+      if (unassigned.size() >= AUCTION_MIN_PARALLEL_BIDS) {
+        parallel_ranges(unassigned.size(), nb_threads, bid);
+      } else {
+        bid(0, unassigned.size());
+      }
+
+      // Assignment phase: each object goes to its highest bidder.
+      bid_for_objects.clear();
+      for (std::size_t k = 0; k < unassigned.size(); ++k) {
+        const index_t j = bid_objects[k];
+        if (best_bidders[j] == UNASSIGNED) {
+          bid_for_objects.push_back(j);
+          best_bidders[j] = k;
+          best_bids[j] = bid_values[k];
+        } else if (bid_values[k] > best_bids[j]) {
+          best_bidders[j] = k;
+          best_bids[j] = bid_values[k];
+        }
+      }
+
+      still_unassigned.clear();
+      for (std::size_t k = 0; k < unassigned.size(); ++k) {
+        const index_t j = bid_objects[k];
+        if (best_bidders[j] != k) {
+          still_unassigned.push_back(unassigned[k]);
+        }
+      }
+      for (const auto j : bid_for_objects) {
+        const index_t i = unassigned[best_bidders[j]];
+        if (owner_of[j] != UNASSIGNED) {
+          object_of[owner_of[j]] = UNASSIGNED;
+          still_unassigned.push_back(owner_of[j]);
+        }
+        owner_of[j] = i;
+        object_of[i] = j;
+        prices[j] = best_bids[j];
+        best_bidders[j] = UNASSIGNED;
+      }
+      unassigned.swap(still_unassigned);
+    }
+
+    if (epsilon <= final_epsilon) {
+      break;
+    }
+    epsilon = std::max(epsilon / AUCTION_SCALING_FACTOR, final_epsilon);
+  }
+
+  for (index_t i = 0; i < n; ++i) {
+    assignment.emplace(i, object_of[i]);
+  }
+  return assignment;
+}
+
+template arena_unordered_map<index_t, index_t>
+auction_assignment(const matrix<cost_t>& m,
+                   unsigned nb_threads,
+                   arena& memory);
@@ -0,0 +1,32 @@
+#ifndef AUCTION_H
+#define AUCTION_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include "../structures/abstract/arena.h"
+#include "../structures/abstract/matrix.h"
+
+// Epsilon is divided by this factor between scaling phases.
+constexpr double AUCTION_SCALING_FACTOR = 4;
+
+// Minimum number of bids in a round to spread bidding across
+// threads.
+constexpr std::size_t AUCTION_MIN_PARALLEL_BIDS = 256;
+
+// Epsilon-scaling auction algorithm for the minimum weight
+// assignment problem, with bids computed in parallel in each
+// round. Final epsilon is below 1 / n so the assignment is optimal
+// for integer costs. Returns the same as
+// minimum_weight_perfect_matching (see munkres.h).
+template <class T>
+arena_unordered_map<index_t, index_t>
+auction_assignment(const matrix<T>& m, unsigned nb_threads, arena& memory);
+
+#endif
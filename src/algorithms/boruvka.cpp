@@ -0,0 +1,253 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+
+#include "../utils/helpers.h"
+#include "./boruvka.h"
+
+// Edges are packed as cost, then smallest vertex, then biggest
+// vertex. Comparing packed values gives a total order on edges so
+// that cheapest edges picked by all components always form a forest,
+// even with equal costs.
+using packed_edge = uint64_t;
+
+constexpr packed_edge NO_EDGE = std::numeric_limits<packed_edge>::max();
+
+inline packed_edge pack_edge(cost_t cost, index_t u, index_t v) {
+  if (v < u) {
+    std::swap(u, v);
+  }
+  return (static_cast<packed_edge>(cost) << 32) |
+         (static_cast<packed_edge>(u) << 16) | static_cast<packed_edge>(v);
+}
+
+// Lock-free union-find: roots are linked with a compare-and-swap,
+// always from the biggest to the smallest index so that no cycle can
+// appear, and paths are halved on the fly during look-ups.
+inline index_t find_root(std::vector<std::atomic<index_t>>& parent,
+                         index_t x) {
+  while (true) {
+    index_t p = parent[x].load();
+    if (p == x) {
+      return x;
+    }
+    index_t gp = parent[p].load();
+    if (gp != p) {
+      parent[x].compare_exchange_weak(p, gp);
+    }
+    x = gp;
+  }
+}
+
+inline bool unite_roots(std::vector<std::atomic<index_t>>& parent,
+                        index_t a,
+                        index_t b) {
+  while (true) {
+    a = find_root(parent, a);
+    b = find_root(parent, b);
+    if (a == b) {
+      return false;
+    }
+    if (a < b) {
+      std::swap(a, b);
+    }
+    index_t expected = a;
+    if (parent[a].compare_exchange_strong(expected, b)) {
+      return true;
+    }
+  }
+}
+
+template <class Matrix>
+std::vector<index_t>
+parallel_minimum_spanning_tree_parents(const Matrix& m, unsigned nb_threads) {
+  const index_t n = m.size();
+  std::vector<index_t> mst_parents(n, 0);
+  if (n < 2) {
+    return mst_parents;
+  }
+
+  // Each round works on a dense matrix between current components,
+  // storing the cheapest packed edge joining two components. The
+  // first round reads costs from m, then the number of components is
+  // at least halved at each round so the overall work stays O(n^2).
+  std::vector<std::vector<index_t>> members(n);
+  for (index_t i = 0; i < n; ++i) {
+    members[i].push_back(i);
+  }
+  std::vector<packed_edge> level_matrix;
+  bool first_round = true;
+
+  std::vector<packed_edge> mst_edges;
+  mst_edges.reserve(n - 1);
+
+  while (members.size() > 1) {
+    const std::size_t nb_components = members.size();
+
+    // Cheapest edge leaving each component.
+    std::vector<packed_edge> cheapest(nb_components, NO_EDGE);
+    auto find_cheapest = [&](std::size_t begin, std::size_t end) {
+      for (std::size_t c = begin; c < end; ++c) {
+        packed_edge best = NO_EDGE;
+        if (first_round) {
+          // Packed order for edges out of c boils down to cost then
+          // other end, so comparing costs is enough here.
+          cost_t best_cost = std::numeric_limits<cost_t>::max();
+          index_t best_v = (c == 0) ? 1 : 0;
+          for (index_t v = 0; v < n; ++v) {
+            const cost_t cost = m(c, v);
+            if (cost < best_cost and v != c) {
+              best_cost = cost;
+              best_v = v;
+            }
+          }
+          best = pack_edge(m(c, best_v), c, best_v);
+        } else {
+          const packed_edge* row = level_matrix.data() + c * nb_components;
+          for (std::size_t d = 0; d < nb_components; ++d) {
+            best = std::min(best, row[d]);
+          }
+        }
+        cheapest[c] = best;
+      }
+    };
+    parallel_ranges(nb_components, nb_threads, find_cheapest);
+
+    // Merge components along their cheapest edges. The same edge
+    // may be picked by both ends, in which case only the first
+    // union succeeds.
+    std::vector<std::atomic<index_t>> uf_parent(nb_components);
+    for (std::size_t c = 0; c < nb_components; ++c) {
+      uf_parent[c].store(c);
+    }
+    std::vector<index_t> component_of(n);
+    for (std::size_t c = 0; c < nb_components; ++c) {
+      for (auto v : members[c]) {
+        component_of[v] = c;
+      }
+    }
+    std::vector<std::vector<packed_edge>> added(nb_threads);
+    std::atomic<unsigned> next_slot(0);
+    auto merge = [&](std::size_t begin, std::size_t end) {
+      auto& local_added = added[next_slot++];
+      for (std::size_t c = begin; c < end; ++c) {
+        assert(cheapest[c] != NO_EDGE);
+        index_t u = (cheapest[c] >> 16) & 0xFFFF;
+        index_t v = cheapest[c] & 0xFFFF;
+        if (unite_roots(uf_parent, component_of[u], component_of[v])) {
+          local_added.push_back(cheapest[c]);
+        }
+      }
+    };
+    parallel_ranges(nb_components, nb_threads, merge);
+    for (const auto& local_added : added) {
+      mst_edges.insert(mst_edges.end(), local_added.begin(), local_added.end());
+    }
+
+    // Relabel merged components.
+    std::vector<index_t> new_label(nb_components);
+    std::vector<std::vector<index_t>> new_members;
+    std::vector<std::vector<index_t>> merged(nb_components);
+    for (std::size_t c = 0; c < nb_components; ++c) {
+      index_t root = find_root(uf_parent, c);
+      if (root == c) {
+        new_label[c] = new_members.size();
+        new_members.emplace_back();
+      }
+    }
+    for (std::size_t c = 0; c < nb_components; ++c) {
+      index_t label = new_label[find_root(uf_parent, c)];
+      new_label[c] = label;
+      merged[label].push_back(c);
+      new_members[label].insert(new_members[label].end(),
+                                members[c].begin(),
+                                members[c].end());
+    }
+    const std::size_t nb_new = new_members.size();
+
+    std::vector<index_t> vertex_label;
+    if (first_round) {
+      vertex_label.resize(n);
+      for (index_t v = 0; v < n; ++v) {
+        vertex_label[v] = new_label[component_of[v]];
+      }
+    }
+
+    if (nb_new > 1) {
+      // Contract the level matrix, each thread owning rows of new
+      // components so that writes never overlap.
+      std::vector<packed_edge> new_level_matrix(nb_new * nb_new, NO_EDGE);
+      auto contract = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) {
+          packed_edge* new_row = new_level_matrix.data() + k * nb_new;
+          if (first_round) {
+            for (auto u : new_members[k]) {
+              for (index_t v = 0; v < n; ++v) {
+                const index_t l = vertex_label[v];
+                if (l != k) {
+                  new_row[l] = std::min(new_row[l], pack_edge(m(u, v), u, v));
+                }
+              }
+            }
+          } else {
+            for (auto c : merged[k]) {
+              const packed_edge* row = level_matrix.data() + c * nb_components;
+              for (std::size_t d = 0; d < nb_components; ++d) {
+                const index_t l = new_label[d];
+                if (l != k) {
+                  new_row[l] = std::min(new_row[l], row[d]);
+                }
+              }
+            }
+          }
+        }
+      };
+      parallel_ranges(nb_new, nb_threads, contract);
+      level_matrix = std::move(new_level_matrix);
+    }
+
+    members = std::move(new_members);
+    first_round = false;
+  }
+  assert(mst_edges.size() == static_cast<std::size_t>(n - 1));
+
+  // Orient tree edges from vertex 0.
+  std::vector<std::vector<index_t>> adjacency(n);
+  for (auto e : mst_edges) {
+    index_t u = (e >> 16) & 0xFFFF;
+    index_t v = e & 0xFFFF;
+    adjacency[u].push_back(v);
+    adjacency[v].push_back(u);
+  }
+  std::vector<unsigned char> visited(n, false);
+  std::vector<index_t> to_visit({0});
+  visited[0] = true;
+  while (!to_visit.empty()) {
+    index_t u = to_visit.back();
+    to_visit.pop_back();
+    for (auto v : adjacency[u]) {
+      if (!visited[v]) {
+        visited[v] = true;
+        mst_parents[v] = u;
+        to_visit.push_back(v);
+      }
+    }
+  }
+
+  return mst_parents;
+}
+
+template std::vector<index_t>
+parallel_minimum_spanning_tree_parents(const matrix<cost_t>& m,
+                                       unsigned nb_threads);
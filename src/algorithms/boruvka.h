@@ -0,0 +1,25 @@
+#ifndef BORUVKA_H
+#define BORUVKA_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <vector>
+
+#include "../structures/abstract/matrix.h"
+#include "../structures/typedefs.h"
+
+// Parallel Borůvka algorithm working directly on a symmetric cost
+// matrix. Returns the minimum spanning tree under the same form as
+// minimum_spanning_tree_parents (see prim.h).
+template <class Matrix>
+std::vector<index_t>
+parallel_minimum_spanning_tree_parents(const Matrix& m, unsigned nb_threads);
+
+#endif
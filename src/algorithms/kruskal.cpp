@@ -54,5 +54,47 @@ undirected_graph<T> minimum_spanning_tree(const undirected_graph<T>& graph) {
   return undirected_graph<T>(mst);
 }
 
+template <class T>
+std::vector<edge<T>> minimum_spanning_forest(std::vector<edge<T>> edges,
+                                             std::size_t nb_vertices) {
+  std::sort(edges.begin(), edges.end(), [](const auto& a, const auto& b) {
+    return a.get_weight() < b.get_weight();
+  });
+
+  std::vector<edge<T>> forest;
+  if (nb_vertices == 0) {
+    return forest;
+  }
+  forest.reserve(nb_vertices - 1);
+
+  std::vector<index_t> representative(nb_vertices);
+  std::iota(representative.begin(), representative.end(), 0);
+  auto find = [&](index_t x) {
+    while (representative[x] != x) {
+      representative[x] = representative[representative[x]];
+      x = representative[x];
+    }
+    return x;
+  };
+
+  for (const auto& edge : edges) {
+    index_t first_rep = find(edge.get_first_vertex());
+    index_t second_rep = find(edge.get_second_vertex());
+    if (first_rep != second_rep) {
+      forest.push_back(edge);
+      representative[second_rep] = first_rep;
+      if (forest.size() == nb_vertices - 1) {
+        break;
+      }
+    }
+  }
+
+  return forest;
+}
+
 template undirected_graph<cost_t>
 minimum_spanning_tree(const undirected_graph<cost_t>& graph);
+
+template std::vector<edge<cost_t>>
+minimum_spanning_forest(std::vector<edge<cost_t>> edges,
+                        std::size_t nb_vertices);
@@ -21,4 +21,11 @@ All rights reserved (see LICENSE).
 template <class T>
 undirected_graph<T> minimum_spanning_tree(const undirected_graph<T>& graph);
 
+// Kruskal algorithm on a sparse edge list using a union-find. Returns
+// the edges of a minimum spanning forest, which has less than
+// nb_vertices - 1 edges if the graph is not connected.
+template <class T>
+std::vector<edge<T>> minimum_spanning_forest(std::vector<edge<T>> edges,
+                                             std::size_t nb_vertices);
+
 #endif
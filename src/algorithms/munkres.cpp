@@ -10,130 +10,124 @@ All rights reserved (see LICENSE).
 #include "./munkres.h"
 
 template <class T>
-std::unordered_map<index_t, index_t>
-minimum_weight_perfect_matching(const matrix<T>& m) {
+arena_unordered_map<index_t, index_t>
+minimum_weight_perfect_matching(const matrix<T>& m, arena& memory) {
+  // Dense array version of the Hungarian algorithm. Labelings and
+  // slacks are stored as signed 64 bits integers to avoid wrapping
+  // around with big costs. Slacks for y in T_set are set to
+  // NO_SLACK so that computing alpha is a plain minimum over the
+  // slack array.
+  using label_t = int64_t;
+  constexpr label_t NO_SLACK = std::numeric_limits<label_t>::max();
+  constexpr index_t UNMATCHED = std::numeric_limits<index_t>::max();
+
+  const index_t n = m.size();
 
   // Trivial initial labeling.
-  std::unordered_map<index_t, T> labeling_x;
-  std::unordered_map<index_t, T> labeling_y;
-  for (index_t i = 0; i < m.size(); ++i) {
-    labeling_y.emplace(i, 0);
+  std::vector<label_t> labeling_x(n);
+  std::vector<label_t> labeling_y(n, 0);
+  for (index_t i = 0; i < n; ++i) {
     T min_weight = std::numeric_limits<T>::max();
-    for (index_t j = 0; j < m.size(); ++j) {
+    for (index_t j = 0; j < n; ++j) {
       if (m[i][j] < min_weight) {
         min_weight = m[i][j];
       }
     }
-    labeling_x.emplace(i, min_weight);
+    labeling_x[i] = min_weight;
   }
 
   // Initial empty matching.
-  std::unordered_map<index_t, index_t> matching_xy;
-  std::unordered_map<index_t, index_t> matching_yx;
-
-  // Alternating tree.
-  std::unordered_map<index_t, index_t> alternating_tree;
-
-  while (matching_xy.size() < m.size()) {
+  std::vector<index_t> matching_xy(n, UNMATCHED);
+  std::vector<index_t> matching_yx(n, UNMATCHED);
+
+  // Alternating tree, slacks and x reaching the current slack value
+  // for each y.
+  std::vector<index_t> alternating_tree(n);
+  std::vector<label_t> slack(n);
+  std::vector<index_t> slack_x(n);
+  std::vector<unsigned char> in_S(n);
+  std::vector<unsigned char> in_T(n);
+
+  index_t unmatched_x = 0;
+  for (index_t matched = 0; matched < n; ++matched) {
     // Step 1.
 
-    alternating_tree.clear();
-    std::set<index_t> S;
-    std::set<index_t> T_set;
-
     // Finding any unmatched x.
-    index_t unmatched_x = 0;
-    while (matching_xy.find(unmatched_x) != matching_xy.end()) {
+    while (matching_xy[unmatched_x] != UNMATCHED) {
       ++unmatched_x;
     }
-    S.insert(unmatched_x);
-
-    // Saving relevant neighbors in equality graph in alternating_tree
-    // and initializing slacks.
-    std::unordered_map<index_t, T> slack;
-    for (index_t y = 0; y < m.size(); ++y) {
-      if (labeling_x.at(unmatched_x) + labeling_y.at(y) == m[unmatched_x][y]) {
-        alternating_tree.emplace(y, unmatched_x);
-      }
-      slack.emplace(y,
-                    m[unmatched_x][y] - labeling_x.at(unmatched_x) -
-                      labeling_y.at(y));
+
+    std::fill(in_S.begin(), in_S.end(), false);
+    std::fill(in_T.begin(), in_T.end(), false);
+    in_S[unmatched_x] = true;
+
+    // Initializing slacks, neighbors in equality graph being those
+    // with a zero slack.
+    for (index_t y = 0; y < n; ++y) {
+      slack[y] = m[unmatched_x][y] - labeling_x[unmatched_x] - labeling_y[y];
+      slack_x[y] = unmatched_x;
     }
 
     bool augmented_path = false;
 
     while (!augmented_path) {
-      // Test if neighbors of S in equality graph equals T_set or not
-      // (note that T_set is included in S neighbors).
-      if (alternating_tree.size() == T_set.size()) {
-        // Step 2.
-
-        T alpha = std::numeric_limits<T>::max();
-        for (index_t y = 0; y < m.size(); ++y) {
-          // Computing alpha, the minimum of slack values over
-          // complement of T_set.
-          if (T_set.find(y) == T_set.end()) {
-            T current_slack = slack.at(y);
-            if (current_slack < alpha) {
-              alpha = current_slack;
-            }
-          }
+      // First y in equality neighbors not in T_set.
+      index_t chosen_y = 0;
+      while (chosen_y < n and slack[chosen_y] != 0) {
+        ++chosen_y;
+      }
+
+      if (chosen_y == n) {
+        // Step 2: neighbors of S in equality graph equals T_set.
+
+        // Computing alpha, the minimum of slack values over
+        // complement of T_set.
+        label_t alpha = NO_SLACK;
+        for (index_t y = 0; y < n; ++y) {
+          alpha = std::min(alpha, slack[y]);
         }
+        assert(alpha != NO_SLACK);
 
-        // Update labelings
-        for (auto const& x : S) {
-          labeling_x.at(x) = labeling_x.at(x) + alpha;
+        // Update labelings.
+        for (index_t x = 0; x < n; ++x) {
+          if (in_S[x]) {
+            labeling_x[x] += alpha;
+          }
         }
-        for (auto const& y : T_set) {
-          labeling_y.at(y) = labeling_y.at(y) - alpha;
+        for (index_t y = 0; y < n; ++y) {
+          if (in_T[y]) {
+            labeling_y[y] -= alpha;
+          } else {
+            slack[y] -= alpha;
+          }
         }
 
-        // Updating relevant neighbors in new equality graph and
-        // updating slacks.
-        for (index_t y = 0; y < m.size(); ++y) {
-          if (T_set.find(y) == T_set.end()) {
-            slack.at(y) = slack.at(y) - alpha;
-
-            for (auto const& x : S) {
-              if (labeling_x.at(x) + labeling_y.at(y) == m[x][y]) {
-                if (alternating_tree.find(y) == alternating_tree.end()) {
-                  alternating_tree.emplace(y, x);
-                }
-              }
-            }
-          }
+        chosen_y = 0;
+        while (slack[chosen_y] != 0) {
+          ++chosen_y;
         }
       }
 
       // Step 3.
+      alternating_tree[chosen_y] = slack_x[chosen_y];
 
-      // First y in equality neighbors not in T_set.
-      index_t chosen_y;
-      for (auto const& edge : alternating_tree) {
-        if (T_set.find(edge.first) == T_set.end()) {
-          // MUST happen before endge reaches the end of
-          // alternating_tree.
-          chosen_y = edge.first;
-          break;
-        }
-      }
-
-      auto matching_y = matching_yx.find(chosen_y);
-      if (matching_y != matching_yx.end()) {
+      const index_t matched_x = matching_yx[chosen_y];
+      if (matched_x != UNMATCHED) {
         // Chosen y is actually matched in M, update S and T_set and
         // proceed to step 2.
-        index_t matched_x = matching_y->second;
-
-        S.insert(matched_x);
-        T_set.insert(chosen_y);
+        in_S[matched_x] = true;
+        in_T[chosen_y] = true;
+        slack[chosen_y] = NO_SLACK;
 
         // Updating slacks.
-        for (index_t y = 0; y < m.size(); ++y) {
-          T current_value = slack.at(y);
-          T new_value =
-            m[matched_x][y] - labeling_x.at(matched_x) - labeling_y.at(y);
-          if (new_value < current_value) {
-            slack.at(y) = new_value;
+        for (index_t y = 0; y < n; ++y) {
+          if (!in_T[y]) {
+            label_t new_value =
+              m[matched_x][y] - labeling_x[matched_x] - labeling_y[y];
+            if (new_value < slack[y]) {
+              slack[y] = new_value;
+              slack_x[y] = matched_x;
+            }
           }
         }
       } else {
@@ -146,44 +140,46 @@ minimum_weight_perfect_matching(const matrix<T>& m) {
         // be removed and (chosen_x, chosen_y) is to be added.
 
         index_t current_y = chosen_y;
-        index_t current_x = alternating_tree.at(current_y);
+        index_t current_x = alternating_tree[current_y];
 
         while (current_x != unmatched_x) {
-          index_t next_y = matching_xy.at(current_x);
-
-          // Remove alternating edge from current matching.
-          matching_xy.erase(matching_xy.find(current_x));
-          matching_yx.erase(matching_yx.find(next_y));
+          index_t next_y = matching_xy[current_x];
 
-          // Add edge from alternating tree to matching.
-          matching_xy.emplace(current_x, current_y);
-          matching_yx.emplace(current_y, current_x);
+          // Replace alternating edge from current matching with edge
+          // from alternating tree.
+          matching_xy[current_x] = current_y;
+          matching_yx[current_y] = current_x;
 
           current_y = next_y;
-          current_x = alternating_tree.at(current_y);
+          current_x = alternating_tree[current_y];
         }
         // Adding last edge from alternating tree.
-        matching_xy.emplace(current_x, current_y);
-        matching_yx.emplace(current_y, current_x);
+        matching_xy[current_x] = current_y;
+        matching_yx[current_y] = current_x;
 
         // Back to step 1.
         augmented_path = true;
       }
     }
   }
-  return matching_xy;
+
+  arena_unordered_map<index_t, index_t> matching(memory);
+  for (index_t x = 0; x < n; ++x) {
+    matching.emplace(x, matching_xy[x]);
+  }
+  return matching;
 }
 
 template <class T>
-std::unordered_map<index_t, index_t>
-greedy_symmetric_approx_mwpm(const matrix<T>& m) {
+arena_unordered_map<index_t, index_t>
+greedy_symmetric_approx_mwpm(const matrix<T>& m, arena& memory) {
   // Fast greedy algorithm for finding a symmetric perfect matching,
   // choosing always smaller possible value, no minimality
   // assured. Matrix size should be even!
   assert(m.size() % 2 == 0);
 
-  std::unordered_map<index_t, index_t> matching;
-  std::set<index_t> remaining_indices;
+  arena_unordered_map<index_t, index_t> matching(memory);
+  arena_set<index_t> remaining_indices(memory);
   for (index_t i = 0; i < m.size(); ++i) {
     remaining_indices.insert(i);
   }
@@ -192,8 +188,8 @@ greedy_symmetric_approx_mwpm(const matrix<T>& m) {
     T min_weight = std::numeric_limits<T>::max();
     index_t first_chosen_index;
     index_t second_chosen_index;
-    std::set<index_t>::iterator chosen_i;
-    std::set<index_t>::iterator chosen_j;
+    arena_set<index_t>::iterator chosen_i;
+    arena_set<index_t>::iterator chosen_j;
     for (auto i = remaining_indices.begin(); i != remaining_indices.end();
          ++i) {
       auto j = i;
@@ -217,8 +213,8 @@ greedy_symmetric_approx_mwpm(const matrix<T>& m) {
   return matching;
 }
 
-template std::unordered_map<index_t, index_t>
-minimum_weight_perfect_matching(const matrix<cost_t>& m);
+template arena_unordered_map<index_t, index_t>
+minimum_weight_perfect_matching(const matrix<cost_t>& m, arena& memory);
 
-template std::unordered_map<index_t, index_t>
-greedy_symmetric_approx_mwpm(const matrix<cost_t>& m);
+template arena_unordered_map<index_t, index_t>
+greedy_symmetric_approx_mwpm(const matrix<cost_t>& m, arena& memory);
@@ -10,21 +10,27 @@ All rights reserved (see LICENSE).
 
 */
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <limits>
 #include <list>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
+#include "../structures/abstract/arena.h"
 #include "../structures/abstract/edge.h"
 #include "../structures/abstract/matrix.h"
 
+// Returned matchings are allocated from memory, which should
+// outlive them.
 template <class T>
-std::unordered_map<index_t, index_t>
-minimum_weight_perfect_matching(const matrix<T>& m);
+arena_unordered_map<index_t, index_t>
+minimum_weight_perfect_matching(const matrix<T>& m, arena& memory);
 
 template <class T>
-std::unordered_map<index_t, index_t>
-greedy_symmetric_approx_mwpm(const matrix<T>& m);
+arena_unordered_map<index_t, index_t>
+greedy_symmetric_approx_mwpm(const matrix<T>& m, arena& memory);
 
 #endif
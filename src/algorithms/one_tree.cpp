@@ -0,0 +1,128 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "../problems/tsp/tour_cost.h"
+#include "../structures/abstract/min_view.h"
+#include "../structures/abstract/penalized_matrix.h"
+#include "./one_tree.h"
+#include "./prim.h"
+
+template <class Matrix>
+cost_t one_tree_lower_bound(const Matrix& m,
+                            cost_t upper_bound,
+                            unsigned nb_iterations) {
+  const index_t n = m.size();
+  if (n < 3) {
+    return 0;
+  }
+
+  // The 1-tree is made of a minimum spanning tree on all vertices but
+  // the last one, plus the two cheapest edges from the last one. As
+  // the complete graph is dense, the spanning tree is computed with
+  // Prim on a penalized view rather than by sorting all edges.
+  const index_t special = n - 1;
+  std::vector<double> penalties(n, 0);
+  std::vector<int> degrees(n);
+
+  double best_bound = 0;
+  double step_scale = 2;
+  unsigned nb_non_improving = 0;
+
+  for (unsigned i = 0; i < nb_iterations; ++i) {
+    penalized_matrix<Matrix> penalized(m, penalties, special);
+    const auto parents = minimum_spanning_tree_parents(penalized);
+
+    std::fill(degrees.begin(), degrees.end(), 0);
+    double tree_cost = 0;
+    for (index_t v = 1; v < special; ++v) {
+      tree_cost += penalized(v, parents[v]);
+      ++degrees[v];
+      ++degrees[parents[v]];
+    }
+
+    // Two cheapest edges linking the special vertex.
+    double first_cost = std::numeric_limits<double>::max();
+    double second_cost = std::numeric_limits<double>::max();
+    index_t first = 0;
+    index_t second = 0;
+    for (index_t v = 0; v < special; ++v) {
+      const double c = m(special, v) + penalties[special] + penalties[v];
+      if (c < first_cost) {
+        second_cost = first_cost;
+        second = first;
+        first_cost = c;
+        first = v;
+      } else if (c < second_cost) {
+        second_cost = c;
+        second = v;
+      }
+    }
+    tree_cost += first_cost + second_cost;
+    degrees[special] = 2;
+    ++degrees[first];
+    ++degrees[second];
+
+    const double penalties_sum =
+      std::accumulate(penalties.cbegin(), penalties.cend(), 0.0);
+    const double bound = tree_cost - 2 * penalties_sum;
+
+    if (bound > best_bound) {
+      best_bound = bound;
+      nb_non_improving = 0;
+    } else if (++nb_non_improving == ONE_TREE_HALVING_PERIOD) {
+      step_scale /= 2;
+      nb_non_improving = 0;
+    }
+
+    double norm = 0;
+    for (const auto d : degrees) {
+      norm += (d - 2) * (d - 2);
+    }
+    if (norm == 0 or best_bound >= upper_bound) {
+      // The 1-tree is a tour so the bound is optimal, or no better
+      // bound is possible.
+      break;
+    }
+
+    // Penalize vertices with too many edges and favor leaves.
+    const double step = step_scale * (upper_bound - bound) / norm;
+    for (index_t v = 0; v < n; ++v) {
+      penalties[v] += step * (degrees[v] - 2);
+    }
+  }
+
+  // Rounding down avoids exceeding an integer optimal cost through
+  // floating-point errors.
+  return std::min(upper_bound, static_cast<cost_t>(std::floor(best_bound)));
+}
+
+template cost_t one_tree_lower_bound(const matrix<cost_t>& m,
+                                     cost_t upper_bound,
+                                     unsigned nb_iterations);
+
+template cost_t one_tree_lower_bound(const min_view<round_trip_cost>& m,
+                                     cost_t upper_bound,
+                                     unsigned nb_iterations);
+
+template cost_t one_tree_lower_bound(const min_view<start_only_cost>& m,
+                                     cost_t upper_bound,
+                                     unsigned nb_iterations);
+
+template cost_t one_tree_lower_bound(const min_view<end_only_cost>& m,
+                                     cost_t upper_bound,
+                                     unsigned nb_iterations);
+
+template cost_t one_tree_lower_bound(const min_view<start_and_end_cost>& m,
+                                     cost_t upper_bound,
+                                     unsigned nb_iterations);
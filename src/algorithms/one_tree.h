@@ -0,0 +1,32 @@
+#ifndef ONE_TREE_H
+#define ONE_TREE_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <vector>
+
+#include "../structures/abstract/matrix.h"
+#include "../structures/typedefs.h"
+
+// Number of non-improving subgradient iterations after which the
+// step size is halved.
+constexpr unsigned ONE_TREE_HALVING_PERIOD = 5;
+
+// Held-Karp lower bound on the cost of any tour for the symmetric
+// matrix m, using nb_iterations of subgradient optimization over
+// penalized 1-trees. Matrix is either a plain matrix or a min view
+// on a cost policy. The upper_bound is the cost of a known tour and
+// is only used to scale subgradient steps.
+template <class Matrix>
+cost_t one_tree_lower_bound(const Matrix& m,
+                            cost_t upper_bound,
+                            unsigned nb_iterations);
+
+#endif
@@ -0,0 +1,80 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <cassert>
+#include <limits>
+#include <type_traits>
+
+#include "../problems/tsp/tour_cost.h"
+#include "../structures/abstract/min_view.h"
+#include "./prim.h"
+
+template <class Matrix>
+std::vector<index_t> minimum_spanning_tree_parents(const Matrix& m) {
+  const index_t n = m.size();
+  std::vector<index_t> parent(n, 0);
+  if (n == 0) {
+    return parent;
+  }
+
+  // Cheapest known connection to the current tree for each vertex
+  // not yet in the tree. Costs are real-valued for penalized
+  // matrices.
+  using value_t = std::decay_t<decltype(m(0, 0))>;
+  std::vector<value_t> key(n, std::numeric_limits<value_t>::max());
+  std::vector<unsigned char> in_tree(n, false);
+
+  index_t current = 0;
+  in_tree[0] = true;
+
+  for (index_t added = 1; added < n; ++added) {
+    // Update keys with edges from the last vertex added to the tree
+    // and pick the cheapest vertex to add next.
+    index_t next = 0;
+    value_t next_key = std::numeric_limits<value_t>::max();
+    for (index_t v = 0; v < n; ++v) {
+      if (in_tree[v]) {
+        continue;
+      }
+      const value_t c = m(current, v);
+      if (c < key[v]) {
+        key[v] = c;
+        parent[v] = current;
+      }
+      if (key[v] < next_key or next == 0) {
+        next_key = key[v];
+        next = v;
+      }
+    }
+    assert(next != 0);
+
+    in_tree[next] = true;
+    current = next;
+  }
+
+  return parent;
+}
+
+template std::vector<index_t>
+minimum_spanning_tree_parents(const matrix<cost_t>& m);
+
+template std::vector<index_t>
+minimum_spanning_tree_parents(const penalized_matrix<matrix<cost_t>>& m);
+
+template std::vector<index_t> minimum_spanning_tree_parents(
+  const penalized_matrix<min_view<round_trip_cost>>& m);
+
+template std::vector<index_t> minimum_spanning_tree_parents(
+  const penalized_matrix<min_view<start_only_cost>>& m);
+
+template std::vector<index_t> minimum_spanning_tree_parents(
+  const penalized_matrix<min_view<end_only_cost>>& m);
+
+template std::vector<index_t> minimum_spanning_tree_parents(
+  const penalized_matrix<min_view<start_and_end_cost>>& m);
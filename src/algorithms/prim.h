@@ -0,0 +1,26 @@
+#ifndef PRIM_H
+#define PRIM_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <vector>
+
+#include "../structures/abstract/matrix.h"
+#include "../structures/abstract/penalized_matrix.h"
+#include "../structures/typedefs.h"
+
+// Dense O(n^2) Prim algorithm working directly on a symmetric cost
+// matrix, without building edges. Matrix is either a plain matrix or
+// a penalized view. Returns the minimum spanning tree
+// as a parent array rooted at vertex 0, with parent[0] == 0.
+template <class Matrix>
+std::vector<index_t> minimum_spanning_tree_parents(const Matrix& m);
+
+#endif
@@ -8,7 +8,10 @@ All rights reserved (see LICENSE).
 */
 
 #include <chrono>
+#include <cmath>
 #include <fstream>
+#include <stdexcept>
+#include <unordered_map>
 #include <unistd.h>
 
 #include <boost/log/core.hpp>
@@ -24,6 +27,16 @@ All rights reserved (see LICENSE).
 #include "./utils/output_json.h"
 #include "./utils/version.h"
 
+// Non-negative integer value for an option, std::stoul silently
+// wrapping negative values around.
+unsigned long to_unsigned(const std::string& arg) {
+  auto first = arg.find_first_not_of(" \t\n");
+  if (first != std::string::npos and arg[first] == '-') {
+    throw std::invalid_argument(arg);
+  }
+  return std::stoul(arg);
+}
+
 void display_usage() {
   std::string usage = "VROOM Copyright (C) 2015-2018, Julien Coupey\n";
   usage += "Version: " + get_version() + "\n";
@@ -39,11 +52,31 @@ void display_usage() {
   // query-time profile selection (yet) so setting it will have no
   // effect for now.
 
+  usage +=
+    "\t-b GAP,\t\t stop TSP local search when the relative gap to\n"
+    "\t\t\t the lower bound is at most GAP (0)\n";
+  usage +=
+    "\t-c HEURISTIC,\t TSP construction heuristic among auto, "
+    "christofides,\n\t\t\t sparse-christofides, assignment-patching,\n"
+    "\t\t\t space-filling-curve, greedy, nearest-neighbour,\n"
+    "\t\t\t held-karp (auto)\n";
+  usage +=
+    "\t-d BUDGET,\t time budget in milliseconds for evaluating other\n"
+    "\t\t\t clusterings than the best one, 0 for no limit (0)\n";
+  usage +=
+    "\t-f FILE,\t file used to persist statistics on clustering\n"
+    "\t\t\t parameters\n";
   usage += "\t-g,\t\t get detailed route geometry for the solution\n";
   usage +=
     "\t-i FILE,\t read input from FILE rather than from\n\t\t\t "
     "command-line\n";
+  usage +=
+    "\t-k NUMBER,\t number of best clusterings evaluated by actual\n"
+    "\t\t\t route cost (1)\n";
   usage += "\t-l,\t\t use libosrm rather than osrm-routed\n";
+  usage +=
+    "\t-n NUMBER,\t max number of clustering parameters to try, most\n"
+    "\t\t\t promising first, 0 for all (0)\n";
   usage += "\t-o OUTPUT,\t output file name\n";
   usage += "\t-t THREADS,\t number of threads to use\n";
   usage += "\t-v,\t\t turn on verbose output\n";
@@ -61,16 +94,34 @@ int main(int argc, char** argv) {
   cl_args_t cl_args;
 
   // Parsing command-line arguments.
-  const char* optString = "a:gi:lm:o:p:t:vVh?";
+  const char* optString = "a:b:c:d:f:gi:k:lm:n:o:p:t:vVh?";
   int opt = getopt(argc, argv, optString);
 
   std::string nb_threads_arg = std::to_string(cl_args.nb_threads);
+  std::string construction_arg = "auto";
+  std::string gap_threshold_arg = std::to_string(cl_args.gap_threshold);
+  std::string evaluated_clusterings_arg =
+    std::to_string(cl_args.evaluated_clusterings);
+  std::string evaluation_budget_arg = std::to_string(cl_args.evaluation_budget);
+  std::string max_clusterings_arg = std::to_string(cl_args.max_clusterings);
 
   while (opt != -1) {
     switch (opt) {
     case 'a':
       cl_args.osrm_address = optarg;
       break;
+    case 'b':
+      gap_threshold_arg = optarg;
+      break;
+    case 'c':
+      construction_arg = optarg;
+      break;
+    case 'd':
+      evaluation_budget_arg = optarg;
+      break;
+    case 'f':
+      cl_args.clustering_stats_file = optarg;
+      break;
     case 'g':
       cl_args.geometry = true;
       break;
@@ -80,12 +131,18 @@ int main(int argc, char** argv) {
     case 'i':
       cl_args.input_file = optarg;
       break;
+    case 'k':
+      evaluated_clusterings_arg = optarg;
+      break;
     case 'l':
       cl_args.use_libosrm = true;
       break;
     case 'm':
       cl_args.osrm_profile = optarg;
       break;
+    case 'n':
+      max_clusterings_arg = optarg;
+      break;
     case 'o':
       cl_args.output_file = optarg;
       break;
@@ -110,7 +167,7 @@ int main(int argc, char** argv) {
   try {
     // Needs to be done after previous switch to make sure the
     // appropriate output file is set.
-    cl_args.nb_threads = std::stoul(nb_threads_arg);
+    cl_args.nb_threads = to_unsigned(nb_threads_arg);
   } catch (const std::exception& e) {
     std::string message = "Wrong value for number of threads.";
     std::cerr << "[Error] " << message << std::endl;
@@ -118,6 +175,47 @@ int main(int argc, char** argv) {
     exit(1);
   }
 
+  try {
+    cl_args.gap_threshold = std::stod(gap_threshold_arg);
+    if (!std::isfinite(cl_args.gap_threshold) or cl_args.gap_threshold < 0) {
+      throw std::invalid_argument(gap_threshold_arg);
+    }
+  } catch (const std::exception& e) {
+    std::string message = "Wrong value for gap threshold.";
+    std::cerr << "[Error] " << message << std::endl;
+    write_to_json({1, message}, false, cl_args.output_file);
+    exit(1);
+  }
+
+  try {
+    cl_args.evaluated_clusterings = to_unsigned(evaluated_clusterings_arg);
+    cl_args.evaluation_budget = to_unsigned(evaluation_budget_arg);
+    cl_args.max_clusterings = to_unsigned(max_clusterings_arg);
+  } catch (const std::exception& e) {
+    std::string message = "Wrong value for clustering options.";
+    std::cerr << "[Error] " << message << std::endl;
+    write_to_json({1, message}, false, cl_args.output_file);
+    exit(1);
+  }
+
+  const std::unordered_map<std::string, CONSTRUCTION_T> constructions =
+    {{"auto", CONSTRUCTION_T::AUTO},
+     {"christofides", CONSTRUCTION_T::CHRISTOFIDES},
+     {"sparse-christofides", CONSTRUCTION_T::SPARSE_CHRISTOFIDES},
+     {"assignment-patching", CONSTRUCTION_T::ASSIGNMENT_PATCHING},
+     {"space-filling-curve", CONSTRUCTION_T::SPACE_FILLING_CURVE},
+     {"greedy", CONSTRUCTION_T::GREEDY},
+     {"nearest-neighbour", CONSTRUCTION_T::NEAREST_NEIGHBOUR},
+     {"held-karp", CONSTRUCTION_T::HELD_KARP}};
+  auto construction = constructions.find(construction_arg);
+  if (construction == constructions.end()) {
+    std::string message = "Wrong value for construction heuristic.";
+    std::cerr << "[Error] " << message << std::endl;
+    write_to_json({1, message}, false, cl_args.output_file);
+    exit(1);
+  }
+  cl_args.construction = construction->second;
+
   if (cl_args.input_file.empty()) {
     // Getting input from command-line.
     if (argc == optind) {
@@ -9,6 +9,8 @@ All rights reserved (see LICENSE).
 
 #include "cvrp.h"
 #include "../../structures/vroom/input/input.h"
+#include "./heuristics/clustering_context.h"
+#include "./heuristics/clustering_portfolio.h"
 
 cvrp::cvrp(const input& input) : vrp(input) {
   for (const auto& v : _input._vehicles) {
@@ -25,74 +27,84 @@ cvrp::cvrp(const input& input) : vrp(input) {
 }
 
 solution cvrp::solve(unsigned nb_threads) const {
-  struct param {
-    CLUSTERING_T type;
-    INIT_T init;
-    double regret_coeff;
-  };
-
   auto start_clustering = std::chrono::high_resolution_clock::now();
   BOOST_LOG_TRIVIAL(info) << "[CVRP] Start clustering heuristic(s).";
 
-  std::vector<param> parameters;
-  parameters.push_back({CLUSTERING_T::PARALLEL, INIT_T::NONE, 0});
-  parameters.push_back({CLUSTERING_T::PARALLEL, INIT_T::NONE, 0.5});
-  parameters.push_back({CLUSTERING_T::PARALLEL, INIT_T::NONE, 1});
-  parameters.push_back({CLUSTERING_T::PARALLEL, INIT_T::NEAREST, 0});
-  parameters.push_back({CLUSTERING_T::PARALLEL, INIT_T::NEAREST, 0.5});
-  parameters.push_back({CLUSTERING_T::PARALLEL, INIT_T::NEAREST, 1});
-  parameters.push_back({CLUSTERING_T::PARALLEL, INIT_T::HIGHER_AMOUNT, 0});
-  parameters.push_back({CLUSTERING_T::PARALLEL, INIT_T::HIGHER_AMOUNT, 0.5});
-  parameters.push_back({CLUSTERING_T::PARALLEL, INIT_T::HIGHER_AMOUNT, 1});
-  parameters.push_back({CLUSTERING_T::SEQUENTIAL, INIT_T::NONE, 0});
-  parameters.push_back({CLUSTERING_T::SEQUENTIAL, INIT_T::NONE, 0.5});
-  parameters.push_back({CLUSTERING_T::SEQUENTIAL, INIT_T::NONE, 1});
-  parameters.push_back({CLUSTERING_T::SEQUENTIAL, INIT_T::NEAREST, 0});
-  parameters.push_back({CLUSTERING_T::SEQUENTIAL, INIT_T::NEAREST, 0.5});
-  parameters.push_back({CLUSTERING_T::SEQUENTIAL, INIT_T::NEAREST, 1});
-  parameters.push_back({CLUSTERING_T::SEQUENTIAL, INIT_T::HIGHER_AMOUNT, 0});
-  parameters.push_back({CLUSTERING_T::SEQUENTIAL, INIT_T::HIGHER_AMOUNT, 0.5});
-  parameters.push_back({CLUSTERING_T::SEQUENTIAL, INIT_T::HIGHER_AMOUNT, 1});
-
-  std::vector<clustering> clusterings;
-  std::mutex clusterings_mutex;
-
-  // Split the work among threads.
-  std::vector<std::vector<std::size_t>>
-    thread_ranks(nb_threads, std::vector<std::size_t>());
-  for (std::size_t i = 0; i < parameters.size(); ++i) {
-    thread_ranks[i % nb_threads].push_back(i);
-  }
-
-  auto run_clustering = [&](const std::vector<std::size_t>& param_ranks) {
-    for (auto rank : param_ranks) {
+  // Initial data is the same for all clusterings.
+  const clustering_context context(_input, nb_threads);
+
+  // Parameters that most often led to the retained clustering for
+  // similar instances are tried first, possibly only them.
+  auto& portfolio = clustering_portfolio::shared();
+  const auto& parameters = portfolio.parameters();
+  const auto features = clustering_portfolio::features(context);
+  const auto& stats_file = _input.get_clustering_stats_file();
+  auto ranks =
+    portfolio.ranks(features, stats_file, _input.get_max_clusterings());
+
+  // Runs are stored by parameter rank so that picking the best one
+  // does not depend on completion order.
+  std::vector<boost::optional<clustering>> clusterings(parameters.size());
+  // Keeping track of as many clusterings as will be evaluated.
+  std::size_t nb_evaluated =
+    std::max(1u, _input.get_evaluated_clusterings());
+  clustering_bound bound(nb_evaluated);
+
+  // Clustering runs and TSP solving are all tasks on a common
+  // executor, so that threads done with their own work steal from
+  // others, e.g. running remaining configurations when some runs are
+  // aborted early.
+  task_executor executor(nb_threads);
+
+  // Submitted in reverse order as the submitting thread runs its own
+  // tasks last in first out.
+  task_group clustering_tasks;
+  for (auto rank = ranks.rbegin(); rank != ranks.rend(); ++rank) {
+    executor.submit(clustering_tasks, [&, rank = *rank]() {
       auto& p = parameters[rank];
-      clustering c(_input, p.type, p.init, p.regret_coeff);
-
-      std::lock_guard<std::mutex> guard(clusterings_mutex);
-      clusterings.push_back(std::move(c));
+      clusterings[rank].emplace(context, bound, p.type, p.init, p.regret_coeff);
+    });
+  }
+  executor.wait(clustering_tasks);
+
+  // Completed runs ordered by unassigned jobs then edges cost, ties
+  // being broken by parameter rank. Aborted runs are provably not
+  // among the ones to evaluate.
+  std::vector<const clustering*> candidates;
+  for (const auto& c : clusterings) {
+    if (c and !c->aborted) {
+      candidates.push_back(&(*c));
     }
-  };
-
-  std::vector<std::thread> clustering_threads;
-
-  for (std::size_t i = 0; i < nb_threads; ++i) {
-    clustering_threads.emplace_back(run_clustering, thread_ranks[i]);
   }
-
-  for (auto& t : clustering_threads) {
-    t.join();
+  std::stable_sort(candidates.begin(),
+                   candidates.end(),
+                   [](auto lhs, auto rhs) {
+                     return lhs->unassigned.size() < rhs->unassigned.size() or
+                            (lhs->unassigned.size() ==
+                               rhs->unassigned.size() and
+                             lhs->edges_cost < rhs->edges_cost);
+                   });
+  // Different parameters may lead to the same clusters, only worth
+  // evaluating once. Identical clusters are not necessarily adjacent
+  // in the above order, nor built with the same edges cost, so each
+  // candidate is checked against all kept ones.
+  std::vector<const clustering*> unique_candidates;
+  for (auto c : candidates) {
+    auto duplicate = std::any_of(unique_candidates.begin(),
+                                 unique_candidates.end(),
+                                 [&](auto kept) {
+                                   return kept->clusters == c->clusters;
+                                 });
+    if (!duplicate) {
+      unique_candidates.push_back(c);
+    }
   }
-
-  auto best_c =
-    std::min_element(clusterings.begin(),
-                     clusterings.end(),
-                     [](auto& lhs, auto& rhs) {
-                       return lhs.unassigned.size() < rhs.unassigned.size() or
-                              (lhs.unassigned.size() ==
-                                 rhs.unassigned.size() and
-                               lhs.edges_cost < rhs.edges_cost);
-                     });
+  candidates = std::move(unique_candidates);
+  if (candidates.size() > nb_evaluated) {
+    candidates.resize(nb_evaluated);
+  }
+  assert(!candidates.empty());
+  const clustering* best_c = candidates.front();
 
   std::string strategy =
     (best_c->type == CLUSTERING_T::PARALLEL) ? "parallel" : "sequential";
@@ -125,60 +137,96 @@ solution cvrp::solve(unsigned nb_threads) const {
 
   BOOST_LOG_TRIVIAL(info) << "[CVRP] Launching TSPs ";
 
-  // Determine non-empty clusters and number of TSP to launch.
-  std::vector<std::size_t> non_empty_cluster_ranks;
-  for (std::size_t i = 0; i < best_c->clusters.size(); ++i) {
-    if (!best_c->clusters[i].empty()) {
-      non_empty_cluster_ranks.push_back(i);
+  // TSP for all non-empty clusters of all candidates, identified by
+  // (candidate rank, vehicle rank).
+  std::vector<std::pair<std::size_t, std::size_t>> tsp_ranks;
+  std::vector<std::vector<solution>> tsp_sols;
+  for (std::size_t c = 0; c < candidates.size(); ++c) {
+    for (std::size_t v = 0; v < candidates[c]->clusters.size(); ++v) {
+      if (!candidates[c]->clusters[v].empty()) {
+        tsp_ranks.emplace_back(c, v);
+      }
     }
+    // Dummy init.
+    tsp_sols.emplace_back(candidates[c]->clusters.size(), solution(0, ""));
   }
-  auto nb_tsp = non_empty_cluster_ranks.size();
-
-  // Create vector of TSP solutions with dummy init.
-  std::vector<solution> tsp_sols(nb_tsp, solution(0, ""));
-
-  // Run TSP solving for a list of clusters in turn, each with
-  // provided number of threads.
-  auto run_tsp = [&](const std::vector<unsigned>& cluster_ranks,
-                     unsigned tsp_threads) {
-    for (auto cl_rank : cluster_ranks) {
-      auto vehicle_rank = non_empty_cluster_ranks[cl_rank];
-      tsp p(_input, best_c->clusters[vehicle_rank], vehicle_rank);
-
-      tsp_sols[cl_rank] = p.solve(tsp_threads);
-    }
+  auto nb_tsp = tsp_ranks.size();
+  auto cluster_size = [&](const std::pair<std::size_t, std::size_t>& rank) {
+    return candidates[rank.first]->clusters[rank.second].size();
   };
 
-  std::vector<std::thread> tsp_threads;
+  // TSP are ordered by candidate, biggest first, so that the best
+  // candidate is solved first and threads done with small TSP then
+  // help with local search on bigger ones. Threads used for
+  // construction are only shared when there are more threads than
+  // TSP.
+  std::stable_sort(tsp_ranks.begin(), tsp_ranks.end(), [&](auto lhs, auto rhs) {
+    return lhs.first < rhs.first or
+           (lhs.first == rhs.first and cluster_size(lhs) > cluster_size(rhs));
+  });
+  unsigned construction_threads = 1;
+  if (0 < nb_tsp and nb_tsp < nb_threads) {
+    construction_threads = nb_threads / nb_tsp;
+  }
+
+  // Other candidates than the best one are only evaluated with the
+  // time budget, TSP not started on time leaving them incomplete.
+  auto budget = _input.get_evaluation_budget();
+  auto deadline = end_clustering + std::chrono::milliseconds(budget);
+  std::vector<std::atomic<bool>> incomplete(candidates.size());
+  for (auto& flag : incomplete) {
+    flag.store(false);
+  }
 
-  if (nb_tsp <= nb_threads) {
-    // We launch nb_tsp TSP solving and each of them can be
-    // multi-threaded.
-    std::vector<unsigned> thread_per_tsp(nb_tsp, 0);
-    for (std::size_t i = 0; i < nb_threads; ++i) {
-      ++thread_per_tsp[i % nb_tsp];
+  auto solve_tsp = [&](const std::pair<std::size_t, std::size_t>& rank) {
+    auto c = rank.first;
+    if (c > 0 and budget > 0 and
+        std::chrono::high_resolution_clock::now() > deadline) {
+      incomplete[c] = true;
+      return;
     }
+    tsp p(_input, candidates[c]->clusters[rank.second], rank.second);
 
-    for (unsigned i = 0; i < nb_tsp; ++i) {
-      std::vector<unsigned> cluster_ranks({i});
-      tsp_threads.emplace_back(run_tsp, cluster_ranks, thread_per_tsp[i]);
-    }
-  } else {
-    // We launch nb_threads threads, each one solving several TSP.
-    std::vector<std::vector<unsigned>>
-    ranks_per_thread(nb_threads, std::vector<unsigned>());
-    for (std::size_t i = 0; i < nb_tsp; ++i) {
-      ranks_per_thread[i % nb_threads].push_back(i);
-    }
+    tsp_sols[c][rank.second] = p.solve(executor, construction_threads);
+  };
 
-    for (std::size_t i = 0; i < nb_threads; ++i) {
-      tsp_threads.emplace_back(run_tsp, ranks_per_thread[i], 1);
+  // TSP for other candidates are only submitted once all TSP for the
+  // best candidate are started, so that no thread picks them first,
+  // which would delay the best candidate and waste time on candidates
+  // left incomplete with the time budget. All TSP are submitted in
+  // reverse order as the submitting thread runs its own tasks last in
+  // first out.
+  const auto best_end =
+    std::find_if(tsp_ranks.begin(), tsp_ranks.end(), [](auto rank) {
+      return rank.first > 0;
+    });
+  const std::size_t nb_best_tsp = best_end - tsp_ranks.begin();
+  std::atomic<std::size_t> nb_started_best(0);
+  task_group other_tsp_tasks;
+  auto submit_others = [&]() {
+    for (auto r = tsp_ranks.rbegin(); r.base() != best_end; ++r) {
+      executor.submit(other_tsp_tasks, [&, rank = *r]() { solve_tsp(rank); });
     }
+  };
+  if (nb_best_tsp == 0) {
+    submit_others();
   }
 
-  for (auto& t : tsp_threads) {
-    t.join();
+  task_group tsp_tasks;
+  for (auto r = std::make_reverse_iterator(best_end); r != tsp_ranks.rend();
+       ++r) {
+    executor.submit(tsp_tasks, [&, rank = *r]() {
+      // Without other threads, TSP are solved in the intended order.
+      assert(nb_started_best > 0 or executor.size() > 1 or
+             rank == tsp_ranks.front());
+      if (++nb_started_best == nb_best_tsp) {
+        submit_others();
+      }
+      solve_tsp(rank);
+    });
   }
+  executor.wait(tsp_tasks);
+  executor.wait(other_tsp_tasks);
 
   auto end_tsps = std::chrono::high_resolution_clock::now();
   auto tsp_computing_time =
@@ -189,11 +237,51 @@ solution cvrp::solve(unsigned nb_threads) const {
   BOOST_LOG_TRIVIAL(info) << "[CVRP] Done with TSPs, took "
                           << tsp_computing_time << " ms.";
 
+  // Pick the candidate with the lowest actual cost among the ones
+  // with the fewest unassigned jobs.
+  std::vector<cost_t> total_costs(candidates.size(), 0);
+  std::size_t best_rank = 0;
+  for (std::size_t c = 0; c < candidates.size(); ++c) {
+    if (incomplete[c]) {
+      continue;
+    }
+    for (std::size_t v = 0; v < candidates[c]->clusters.size(); ++v) {
+      if (!candidates[c]->clusters[v].empty()) {
+        total_costs[c] += tsp_sols[c][v].summary.cost;
+      }
+    }
+    if (candidates[c]->unassigned.size() ==
+          candidates[best_rank]->unassigned.size() and
+        total_costs[c] < total_costs[best_rank]) {
+      best_rank = c;
+    }
+    BOOST_LOG_TRIVIAL(trace) << "Evaluated clustering:" << c << ";"
+                             << candidates[c]->unassigned.size() << ";"
+                             << candidates[c]->edges_cost << ";"
+                             << total_costs[c];
+  }
+  if (best_rank > 0) {
+    best_c = candidates[best_rank];
+    BOOST_LOG_TRIVIAL(info) << "[CVRP] Picked clustering ranked "
+                            << best_rank + 1 << " by edges cost.";
+  }
+
+  // Credit the first parameters leading to the retained clustering.
+  for (auto rank : ranks) {
+    if (clusterings[rank] and !clusterings[rank]->aborted and
+        clusterings[rank]->edges_cost == best_c->edges_cost and
+        clusterings[rank]->clusters == best_c->clusters) {
+      portfolio.record(features, stats_file, ranks, rank);
+      break;
+    }
+  }
+
   std::vector<route_t> routes;
-  cost_t total_cost = 0;
-  for (const auto& tsp_sol : tsp_sols) {
-    routes.push_back(tsp_sol.routes[0]);
-    total_cost += tsp_sol.summary.cost;
+  cost_t total_cost = total_costs[best_rank];
+  for (std::size_t v = 0; v < best_c->clusters.size(); ++v) {
+    if (!best_c->clusters[v].empty()) {
+      routes.push_back(tsp_sols[best_rank][v].routes[0]);
+    }
   }
 
   std::vector<job_t> unassigned_jobs;
@@ -10,8 +10,9 @@ All rights reserved (see LICENSE).
 
 */
 
-#include <mutex>
-#include <thread>
+#include <atomic>
+#include <cassert>
+#include <utility>
 
 #include "../tsp/tsp.h"
 #include "../vrp.h"
@@ -6,31 +6,76 @@ All rights reserved (see LICENSE).
 
 */
 
+#include <limits>
+
 #include "clustering.h"
+#include "clustering_context.h"
+
+clustering_bound::clustering_bound(std::size_t k)
+  : _k(std::max<std::size_t>(k, 1)),
+    _threshold(std::numeric_limits<uint64_t>::max()) {
+}
 
-clustering::clustering(const input& input, CLUSTERING_T t, INIT_T i, double c)
-  : input_ref(input),
+uint64_t clustering_bound::pack(std::size_t nb_unassigned, cost_t cost) {
+  static_assert(sizeof(cost_t) <= 4, "cost_t should fit in lower bits");
+  return (static_cast<uint64_t>(nb_unassigned) << 32) | cost;
+}
+
+bool clustering_bound::dominates(std::size_t nb_unassigned,
+                                 cost_t cost) const {
+  return _threshold.load(std::memory_order_relaxed) <
+         pack(nb_unassigned, cost);
+}
+
+void clustering_bound::update(std::size_t nb_unassigned, cost_t cost) {
+  auto value = pack(nb_unassigned, cost);
+
+  std::lock_guard<std::mutex> lock(_outcomes_mutex);
+  _outcomes.insert(std::upper_bound(_outcomes.begin(), _outcomes.end(), value),
+                   value);
+  if (_outcomes.size() > _k) {
+    _outcomes.pop_back();
+  }
+  if (_outcomes.size() == _k) {
+    _threshold.store(_outcomes.back(), std::memory_order_relaxed);
+  }
+}
+
+clustering::clustering(const clustering_context& context,
+                       clustering_bound& bound,
+                       CLUSTERING_T t,
+                       INIT_T i,
+                       double c)
+  : input_ref(context.input_ref),
+    assigned(input_ref._jobs.size(), false),
+    nb_assigned(0),
     type(t),
     init(i),
     regret_coeff(c),
-    clusters(input._vehicles.size()),
-    edges_cost(0) {
-  // All job ranks start with unassigned status.
-  for (unsigned i = 0; i < input_ref._jobs.size(); ++i) {
-    unassigned.insert(i);
-  }
+    clusters(input_ref._vehicles.size()),
+    edges_cost(0),
+    aborted(false) {
 
   std::string strategy;
   switch (type) {
   case CLUSTERING_T::PARALLEL:
-    this->parallel_clustering();
+    this->parallel_clustering(context, bound);
     strategy = "parallel";
     break;
   case CLUSTERING_T::SEQUENTIAL:
-    this->sequential_clustering();
+    this->sequential_clustering(context, bound);
     strategy = "sequential";
     break;
   }
+  for (index_t j = 0; j < assigned.size(); ++j) {
+    if (!assigned[j]) {
+      unassigned.push_back(j);
+    }
+  }
+  if (!aborted) {
+    bound.update(unassigned.size(), edges_cost);
+  }
+
   std::string init_str;
   switch (init) {
   case INIT_T::NONE:
@@ -46,70 +91,95 @@ clustering::clustering(const input& input, CLUSTERING_T t, INIT_T i, double c)
   BOOST_LOG_TRIVIAL(trace) << "Clustering:" << strategy << ";" << init_str
                            << ";" << this->regret_coeff << ";"
                            << this->unassigned.size() << ";"
-                           << this->edges_cost;
+                           << this->edges_cost << (aborted ? ";aborted" : "");
+}
+
+bool clustering::is_dominated(const clustering_context& context,
+                              const clustering_bound& bound,
+                              std::size_t nb_dropped) const {
+  // At least nb_dropped jobs end up unassigned. If the final number
+  // is higher than for the best outcome, this run loses anyway, so
+  // only the case where all other jobs get assigned matters for the
+  // cost bound.
+  auto nb_additions = assigned.size() - nb_dropped - nb_assigned;
+  uint64_t cost = static_cast<uint64_t>(edges_cost) +
+                  context.additions_lower_bounds[nb_additions];
+  cost = std::min<uint64_t>(cost, std::numeric_limits<cost_t>::max());
+  return bound.dominates(nb_dropped, static_cast<cost_t>(cost));
+}
+
+void clustering::assign(index_t v, index_t j, cost_t cost) {
+  clusters[v].push_back(j);
+  assigned[j] = true;
+  ++nb_assigned;
+  edges_cost += cost;
 }
 
-inline void update_cost(index_t from_index,
-                        std::vector<cost_t>& costs,
-                        std::vector<index_t>& parents,
-                        const std::vector<index_t>& candidates,
-                        const std::vector<job_t>& jobs,
-                        const matrix<cost_t>& m) {
-  // Update cost of reaching all candidates (seen as neighbours of
-  // "from_index").
+inline std::vector<index_t> update_cost(index_t from_rank,
+                                        std::vector<cost_t>& costs,
+                                        std::vector<index_t>& parents,
+                                        const indexed_heap& candidates,
+                                        const std::vector<job_t>& jobs,
+                                        const matrix<cost_t>& job_costs) {
+  // Update cost of reaching all candidates (seen as neighbours of job
+  // at "from_rank"). Returns candidates whose cost decreased so that
+  // their score can be updated once done iterating over the heap.
+  std::vector<index_t> updated;
+  const auto& from_costs = job_costs[from_rank];
   for (auto j : candidates) {
-    auto current_cost =
-      std::min(m[from_index][jobs[j].index()], m[jobs[j].index()][from_index]);
-    if (current_cost < costs[j]) {
-      costs[j] = current_cost;
-      parents[j] = from_index;
+    if (from_costs[j] < costs[j]) {
+      costs[j] = from_costs[j];
+      parents[j] = jobs[from_rank].index();
+      updated.push_back(j);
     }
   }
+  return updated;
 }
 
-void clustering::parallel_clustering() {
+// Set scores for all candidates in heap, e.g. once costs and regrets
+// are initialized.
+template <class Score>
+inline void set_scores(indexed_heap& candidates, Score score) {
+  const std::vector<index_t> items(candidates.begin(), candidates.end());
+  for (auto j : items) {
+    candidates.update(j, score(j));
+  }
+}
+
+void clustering::parallel_clustering(const clustering_context& context,
+                                     const clustering_bound& bound) {
   auto V = input_ref._vehicles.size();
   auto J = input_ref._jobs.size();
   auto& jobs = input_ref._jobs;
   auto& vehicles = input_ref._vehicles;
-  auto m = input_ref.get_matrix();
-
-  // Current best known costs to add jobs to vehicle clusters.
-  std::vector<std::vector<cost_t>>
-    costs(V, std::vector<cost_t>(J, std::numeric_limits<cost_t>::max()));
-
-  // For each vehicle cluster, we need to maintain a vector of job
-  // candidates (represented by their index in 'jobs'). Initialization
-  // updates all costs related to start/end for each vehicle cluster.
-  std::vector<std::vector<index_t>> candidates(V);
 
-  // Remember wanabee parent for each job in each cluster.
-  std::vector<std::vector<index_t>> parents(V, std::vector<index_t>(J));
+  // Current best known costs to add jobs to vehicle clusters,
+  // starting with costs related to start/end for each vehicle
+  // cluster.
+  std::vector<std::vector<cost_t>> costs = context.costs;
 
+  // For each vehicle cluster, we need to maintain a heap of job
+  // candidates (represented by their index in 'jobs'), sorted by
+  // score. Only jobs compatible with vehicle skills are candidates.
+  std::vector<indexed_heap> candidates(V, indexed_heap(J));
   for (std::size_t v = 0; v < V; ++v) {
-    // Only keep jobs compatible with vehicle skills in candidates.
-    for (std::size_t j = 0; j < J; ++j) {
-      if (input_ref._vehicle_to_job_compatibility[v][j]) {
-        candidates[v].push_back(j);
-      }
+    for (auto j : context.candidates[v]) {
+      candidates[v].push(j, 0);
     }
+  }
 
-    if (vehicles[v].has_start()) {
-      auto start_index = vehicles[v].start.get().index();
-      update_cost(start_index, costs[v], parents[v], candidates[v], jobs, m);
-
-      if (vehicles[v].has_end()) {
-        auto end_index = vehicles[v].end.get().index();
-        if (start_index != end_index) {
-          update_cost(end_index, costs[v], parents[v], candidates[v], jobs, m);
-        }
-      }
-    } else {
-      assert(vehicles[v].has_end());
-      auto end_index = vehicles[v].end.get().index();
-      update_cost(end_index, costs[v], parents[v], candidates[v], jobs, m);
+  // Number of heaps holding each job, jobs dropped from all heaps
+  // before being assigned can't be assigned any more.
+  std::vector<index_t> nb_heaps(J, 0);
+  for (std::size_t v = 0; v < V; ++v) {
+    for (auto j : context.candidates[v]) {
+      ++nb_heaps[j];
     }
   }
+  std::size_t nb_dropped = std::count(nb_heaps.begin(), nb_heaps.end(), 0);
+
+  // Remember wanabee parent for each job in each cluster.
+  std::vector<std::vector<index_t>> parents = context.parents;
 
   // Remember current capacity left in clusters.
   std::vector<amount_t> capacities;
@@ -117,24 +187,11 @@ void clustering::parallel_clustering() {
     capacities.emplace_back(vehicles[v].capacity.get());
   }
 
-  // Regrets[v][j] is the min cost of reaching jobs[j] from another
-  // cluster than v. It serves as an indicator of the cost we'll have
-  // to support later when NOT including a job to the current cluster.
-  std::vector<std::vector<cost_t>> regrets(V, std::vector<cost_t>(J, 0));
-  for (std::size_t v = 0; v < V; ++v) {
-    for (auto j : candidates[v]) {
-      auto current_regret = std::numeric_limits<cost_t>::max();
-      for (std::size_t other_v = 0; other_v < V; ++other_v) {
-        // Cost from other clusters that potentially can handle job.
-        if ((v == other_v) or
-            (costs[other_v][j] == std::numeric_limits<cost_t>::max())) {
-          continue;
-        }
-        current_regret = std::min(current_regret, costs[other_v][j]);
-      }
-      regrets[v][j] = current_regret;
-    }
-  }
+  // Top_costs[j].regret(v) is the min cost of reaching jobs[j] from
+  // another cluster than v. It serves as an indicator of the cost
+  // we'll have to support later when NOT including a job to the
+  // current cluster.
+  std::vector<top_two_costs> top_costs = context.top_costs;
 
   // Cluster initialization: define available initialization
   // strategies then run initialization sequentially on all clusters.
@@ -142,7 +199,7 @@ void clustering::parallel_clustering() {
   // Initialize cluster with the job that has higher amount (and is
   // the further away in case of amount tie).
   auto higher_amount_init_lambda = [&](auto v) {
-    return [&](index_t lhs, index_t rhs) {
+    return [&, v](index_t lhs, index_t rhs) {
       return jobs[lhs].amount.get() < jobs[rhs].amount.get() or
              (jobs[lhs].amount.get() == jobs[rhs].amount.get() and
               costs[v][lhs] < costs[v][rhs]);
@@ -150,83 +207,75 @@ void clustering::parallel_clustering() {
   };
   // Initialize cluster with the nearest job.
   auto nearest_init_lambda = [&](auto v) {
-    return
-      [&](index_t lhs, index_t rhs) { return costs[v][lhs] < costs[v][rhs]; };
+    return [&, v](index_t lhs, index_t rhs) {
+      return costs[v][lhs] < costs[v][rhs];
+    };
   };
 
   if (init != INIT_T::NONE) {
     for (std::size_t v = 0; v < V; ++v) {
-      auto init_job = candidates[v].cend();
+      auto init_job = candidates[v].end();
       if (init == INIT_T::HIGHER_AMOUNT) {
-        init_job = std::max_element(candidates[v].cbegin(),
-                                    candidates[v].cend(),
+        init_job = std::max_element(candidates[v].begin(),
+                                    candidates[v].end(),
                                     higher_amount_init_lambda(v));
       }
       if (init == INIT_T::NEAREST) {
-        init_job = std::min_element(candidates[v].cbegin(),
-                                    candidates[v].cend(),
+        init_job = std::min_element(candidates[v].begin(),
+                                    candidates[v].end(),
                                     nearest_init_lambda(v));
       }
 
-      if (init_job != candidates[v].cend()) {
+      if (init_job != candidates[v].end()) {
         auto job_rank = *init_job;
-        clusters[v].push_back(job_rank);
-        unassigned.erase(job_rank);
-        edges_cost += costs[v][job_rank];
+        assign(v, job_rank, costs[v][job_rank]);
         capacities[v] -= jobs[job_rank].amount.get();
-        candidates[v].erase(init_job);
+        candidates[v].erase(job_rank);
 
         BOOST_LOG_TRIVIAL(trace) << vehicles[v].id << ";"
                                  << parents[v][job_rank] << "->"
                                  << jobs[job_rank].index();
 
-        update_cost(jobs[job_rank].index(),
-                    costs[v],
-                    parents[v],
-                    candidates[v],
-                    jobs,
-                    m);
-        // Update regrets as costs from matching cluster to job
-        // candidates potentially decreases.
-        for (auto j : candidates[v]) {
-          auto new_cost = std::min(m[jobs[job_rank].index()][jobs[j].index()],
-                                   m[jobs[j].index()][jobs[job_rank].index()]);
-          for (std::size_t other_v = 0; other_v < V; ++other_v) {
-            // Regret for other clusters that potentially can handle job.
-            if ((other_v == v) or
-                (costs[other_v][j] == std::numeric_limits<cost_t>::max())) {
-              continue;
-            }
-            regrets[other_v][j] = std::min(regrets[other_v][j], new_cost);
-          }
+        // Regrets for other clusters follow decreasing costs.
+        for (auto j : update_cost(job_rank,
+                                  costs[v],
+                                  parents[v],
+                                  candidates[v],
+                                  jobs,
+                                  context.job_costs)) {
+          top_costs[j].update(v, costs[v][j]);
         }
 
         for (std::size_t other_v = 0; other_v < V; ++other_v) {
-          if (other_v != v) {
-            auto search = std::find(candidates[other_v].begin(),
-                                    candidates[other_v].end(),
-                                    job_rank);
-            if (search != candidates[other_v].end()) {
-              candidates[other_v].erase(search);
-            }
+          if (other_v != v and candidates[other_v].contains(job_rank)) {
+            candidates[other_v].erase(job_rank);
           }
         }
       }
     }
   }
 
-  auto eval_lambda = [&](auto v) {
-    return [&](auto i, auto j) {
-      return regret_coeff * static_cast<double>(regrets[v][i]) -
-               static_cast<double>(costs[v][i]) <
-             regret_coeff * static_cast<double>(regrets[v][j]) -
-               static_cast<double>(costs[v][j]);
+  // Candidates are picked based on a score mixing cost and regret.
+  // Scores are set once costs and regrets are initialized, then only
+  // updated for jobs whose cost or regret changes.
+  auto score = [&](auto v) {
+    return [&, v](index_t j) {
+      return regret_coeff * static_cast<double>(top_costs[j].regret(v)) -
+             static_cast<double>(costs[v][j]);
     };
   };
+  for (std::size_t v = 0; v < V; ++v) {
+    set_scores(candidates[v], score(v));
+  }
 
   bool candidates_remaining = true;
 
   while (candidates_remaining) {
+    if (is_dominated(context, bound, nb_dropped)) {
+      aborted = true;
+      return;
+    }
+
     // Remember best cluster and job candidate.
     bool capacity_ok = false;
     index_t best_v = 0; // Dummy init, value never used.
@@ -239,11 +288,7 @@ void clustering::parallel_clustering() {
       }
 
       // Consider best job candidate for current cluster.
-      std::make_heap(candidates[v].begin(),
-                     candidates[v].end(),
-                     eval_lambda(v));
-
-      auto current_j = candidates[v].front();
+      auto current_j = candidates[v].top();
       if (jobs[current_j].amount.get() <= capacities[v] and
           (costs[v][current_j] < best_cost or
            (costs[v][current_j] == best_cost and
@@ -271,10 +316,10 @@ void clustering::parallel_clustering() {
         if (candidates[v].empty()) {
           continue;
         }
-        std::pop_heap(candidates[v].begin(),
-                      candidates[v].end(),
-                      eval_lambda(v));
-        candidates[v].pop_back();
+        if (--nb_heaps[candidates[v].top()] == 0) {
+          ++nb_dropped;
+        }
+        candidates[v].pop();
 
         candidates_remaining |= !candidates[v].empty();
       }
@@ -283,46 +328,42 @@ void clustering::parallel_clustering() {
 
     // Add best candidate to matching cluster and remove from all
     // candidate vectors.
-    clusters[best_v].push_back(best_j);
-    unassigned.erase(best_j);
-    edges_cost += best_cost;
+    assign(best_v, best_j, best_cost);
     BOOST_LOG_TRIVIAL(trace) << vehicles[best_v].id << ";"
                              << parents[best_v][best_j] << "->"
                              << jobs[best_j].index();
     capacities[best_v] -= jobs[best_j].amount.get();
 
-    std::pop_heap(candidates[best_v].begin(),
-                  candidates[best_v].end(),
-                  eval_lambda(best_v));
-    candidates[best_v].pop_back();
-    update_cost(jobs[best_j].index(),
-                costs[best_v],
-                parents[best_v],
-                candidates[best_v],
-                jobs,
-                m);
-    // Update regrets as costs from matching cluster to job candidates
-    // potentially decreases.
-    for (auto j : candidates[best_v]) {
-      auto new_cost = std::min(m[jobs[best_j].index()][jobs[j].index()],
-                               m[jobs[j].index()][jobs[best_j].index()]);
-      for (std::size_t other_v = 0; other_v < V; ++other_v) {
-        // Regret for other clusters that potentially can handle job.
-        if ((other_v == best_v) or
-            (costs[other_v][j] == std::numeric_limits<cost_t>::max())) {
-          continue;
+    assert(candidates[best_v].top() == best_j);
+    candidates[best_v].pop();
+    for (auto j : update_cost(best_j,
+                              costs[best_v],
+                              parents[best_v],
+                              candidates[best_v],
+                              jobs,
+                              context.job_costs)) {
+      candidates[best_v].update(j, score(best_v)(j));
+
+      // Regrets for other clusters only change when the cheapest or
+      // second cheapest cost decreases.
+      auto previous = top_costs[j];
+      top_costs[j].update(best_v, costs[best_v][j]);
+      if (top_costs[j].best < previous.best) {
+        for (std::size_t other_v = 0; other_v < V; ++other_v) {
+          if (other_v != best_v and candidates[other_v].contains(j)) {
+            candidates[other_v].update(j, score(other_v)(j));
+          }
         }
-        regrets[other_v][j] = std::min(regrets[other_v][j], new_cost);
+      } else if (top_costs[j].second_best < previous.second_best and
+                 candidates[top_costs[j].best_v].contains(j)) {
+        candidates[top_costs[j].best_v].update(j,
+                                               score(top_costs[j].best_v)(j));
       }
     }
 
     for (std::size_t v = 0; v < V; ++v) {
-      if (v != best_v) {
-        auto search =
-          std::find(candidates[v].begin(), candidates[v].end(), best_j);
-        if (search != candidates[v].end()) {
-          candidates[v].erase(search);
-        }
+      if (v != best_v and candidates[v].contains(best_j)) {
+        candidates[v].erase(best_j);
       }
 
       candidates_remaining |= !candidates[v].empty();
@@ -330,67 +371,49 @@ void clustering::parallel_clustering() {
   }
 }
 
-void clustering::sequential_clustering() {
+void clustering::sequential_clustering(const clustering_context& context,
+                                       const clustering_bound& bound) {
   auto V = input_ref._vehicles.size();
   auto J = input_ref._jobs.size();
   auto& jobs = input_ref._jobs;
   auto& vehicles = input_ref._vehicles;
-  auto m = input_ref.get_matrix();
-
-  // For each vehicle cluster, we need to initialize a vector of job
-  // candidates (represented by their index in 'jobs').
-  std::unordered_set<index_t> candidates_set;
-  for (index_t i = 0; i < J; ++i) {
-    candidates_set.insert(i);
-  }
 
   // Remember initial cost of reaching a job from a vehicle (based on
   // start/end loc).
-  std::vector<std::vector<cost_t>> vehicles_to_job_costs(V,
-                                                         std::vector<cost_t>(
-                                                           J));
-
-  for (std::size_t j = 0; j < J; ++j) {
-    for (std::size_t v = 0; v < V; ++v) {
-      cost_t current_cost = std::numeric_limits<cost_t>::max();
-      if (vehicles[v].has_start()) {
-        auto start_index = vehicles[v].start.get().index();
-        current_cost = std::min(current_cost, m[start_index][jobs[j].index()]);
-      }
-      if (vehicles[v].has_end()) {
-        auto end_index = vehicles[v].end.get().index();
-        current_cost = std::min(current_cost, m[jobs[j].index()][end_index]);
-      }
-      vehicles_to_job_costs[v][j] = current_cost;
-    }
-  }
+  const auto& vehicles_to_job_costs = context.vehicles_to_job_costs;
 
   // Regrets[v][j] is the min cost of reaching jobs[j] from another
   // yet-to-build cluster after v. It serves as an indicator of the
   // cost we'll have to support later when NOT including a job to the
   // current cluster.
-  std::vector<std::vector<cost_t>> regrets(V, std::vector<cost_t>(J, 0));
-
-  if (vehicles.size() > 1) {
-    // Regret for penultimate cluster is the cost for last
-    // vehicle. Previous values are computed backward.
-    for (std::size_t j = 0; j < J; ++j) {
-      regrets[V - 2][j] = vehicles_to_job_costs[V - 1][j];
-    }
-    for (std::size_t i = 3; i <= V; ++i) {
-      for (std::size_t j = 0; j < J; ++j) {
-        regrets[V - i][j] =
-          std::min(regrets[V - i + 1][j], vehicles_to_job_costs[V - i + 1][j]);
+  const auto& regrets = context.sequential_regrets;
+
+  // Jobs still unassigned once the last vehicle able to handle them
+  // is done can't be assigned any more.
+  std::vector<std::vector<index_t>> last_chances(V);
+  {
+    std::vector<bool> handled(J, false);
+    for (std::size_t v = V; v-- > 0;) {
+      for (auto j : context.candidates[v]) {
+        if (!handled[j] and
+            jobs[j].amount.get() <= vehicles[v].capacity.get()) {
+          handled[j] = true;
+          last_chances[v].push_back(j);
+        }
       }
     }
   }
+  std::size_t nb_dropped = J;
+  for (const auto& jobs_ranks : last_chances) {
+    nb_dropped -= jobs_ranks.size();
+  }
 
   // Define available initialization strategies.
 
   // Initialize cluster with the job that has higher amount (and is
   // the further away in case of amount tie).
   auto higher_amount_init_lambda = [&](auto v) {
-    return [&](index_t lhs, index_t rhs) {
+    return [&, v](index_t lhs, index_t rhs) {
       return jobs[lhs].amount.get() < jobs[rhs].amount.get() or
              (jobs[lhs].amount.get() == jobs[rhs].amount.get() and
               vehicles_to_job_costs[v][lhs] < vehicles_to_job_costs[v][rhs]);
@@ -398,7 +421,7 @@ void clustering::sequential_clustering() {
   };
   // Initialize cluster with the nearest job.
   auto nearest_init_lambda = [&](auto v) {
-    return [&](index_t lhs, index_t rhs) {
+    return [&, v](index_t lhs, index_t rhs) {
       return vehicles_to_job_costs[v][lhs] < vehicles_to_job_costs[v][rhs];
     };
   };
@@ -406,106 +429,94 @@ void clustering::sequential_clustering() {
   for (std::size_t v = 0; v < V; ++v) {
     // Initialization with remaining compatible jobs while remembering
     // costs to jobs for current vehicle.
-    std::vector<index_t> candidates;
-    for (auto i : candidates_set) {
-      if (input_ref._vehicle_to_job_compatibility[v][i] and
+    indexed_heap candidates(J);
+    for (auto i : context.candidates[v]) {
+      if (!assigned[i] and
           jobs[i].amount.get() <= input_ref._vehicles[v].capacity.get()) {
-        candidates.push_back(i);
+        candidates.push(i, 0);
       }
     }
 
-    // Current best known costs to add jobs to current vehicle cluster.
-    std::vector<cost_t> costs(J, std::numeric_limits<cost_t>::max());
+    // Current best known costs to add jobs to current vehicle cluster,
+    // starting with costs related to start/end.
+    std::vector<cost_t> costs = context.costs[v];
 
     // Remember wanabee parent for each job.
-    std::vector<index_t> parents(J);
-
-    // Updating costs related to start/end for each vehicle cluster.
-    if (vehicles[v].has_start()) {
-      auto start_index = vehicles[v].start.get().index();
-      update_cost(start_index, costs, parents, candidates, jobs, m);
-
-      if (vehicles[v].has_end()) {
-        auto end_index = vehicles[v].end.get().index();
-        if (start_index != end_index) {
-          update_cost(end_index, costs, parents, candidates, jobs, m);
-        }
-      }
-    } else {
-      assert(vehicles[v].has_end());
-      auto end_index = vehicles[v].end.get().index();
-      update_cost(end_index, costs, parents, candidates, jobs, m);
-    }
+    std::vector<index_t> parents = context.parents[v];
 
     // Remember current capacity left in cluster.
     auto capacity = vehicles[v].capacity.get();
 
     // Strategy for cluster initialization.
     if (init != INIT_T::NONE) {
-      auto init_job = candidates.cend();
+      auto init_job = candidates.end();
       if (init == INIT_T::HIGHER_AMOUNT) {
-        init_job = std::max_element(candidates.cbegin(),
-                                    candidates.cend(),
+        init_job = std::max_element(candidates.begin(),
+                                    candidates.end(),
                                     higher_amount_init_lambda(v));
       }
       if (init == INIT_T::NEAREST) {
-        init_job = std::min_element(candidates.cbegin(),
-                                    candidates.cend(),
+        init_job = std::min_element(candidates.begin(),
+                                    candidates.end(),
                                     nearest_init_lambda(v));
       }
 
-      if (init_job != candidates.cend()) {
+      if (init_job != candidates.end()) {
         auto job_rank = *init_job;
-        clusters[v].push_back(job_rank);
-        unassigned.erase(job_rank);
-        edges_cost += vehicles_to_job_costs[v][job_rank];
+        assign(v, job_rank, vehicles_to_job_costs[v][job_rank]);
         capacity -= jobs[job_rank].amount.get();
-        candidates_set.erase(job_rank);
-        candidates.erase(init_job);
+        candidates.erase(job_rank);
 
         BOOST_LOG_TRIVIAL(trace) << vehicles[v].id << ";" << parents[job_rank]
                                  << "->" << jobs[job_rank].index();
 
-        update_cost(jobs[job_rank].index(),
+        update_cost(job_rank,
                     costs,
                     parents,
                     candidates,
                     jobs,
-                    m);
+                    context.job_costs);
       }
     }
 
-    auto eval_lambda = [&](auto i, auto j) {
-      return regret_coeff * static_cast<double>(regrets[v][i]) -
-               static_cast<double>(costs[i]) <
-             regret_coeff * static_cast<double>(regrets[v][j]) -
-               static_cast<double>(costs[j]);
+    // Candidates are picked based on a score mixing cost and regret,
+    // only updated for jobs whose cost changes.
+    auto score = [&](index_t j) {
+      return regret_coeff * static_cast<double>(regrets[v][j]) -
+             static_cast<double>(costs[j]);
     };
+    set_scores(candidates, score);
 
     while (!candidates.empty()) {
-      std::make_heap(candidates.begin(), candidates.end(), eval_lambda);
+      if (is_dominated(context, bound, nb_dropped)) {
+        aborted = true;
+        return;
+      }
 
-      auto current_j = candidates.front();
+      auto current_j = candidates.top();
+      candidates.pop();
 
       if (jobs[current_j].amount.get() <= capacity) {
-        clusters[v].push_back(current_j);
-        unassigned.erase(current_j);
-        edges_cost += costs[current_j];
+        assign(v, current_j, costs[current_j]);
         BOOST_LOG_TRIVIAL(trace) << vehicles[v].id << ";" << parents[current_j]
                                  << "->" << jobs[current_j].index();
         capacity -= jobs[current_j].amount.get();
-        candidates_set.erase(current_j);
 
-        update_cost(jobs[current_j].index(),
-                    costs,
-                    parents,
-                    candidates,
-                    jobs,
-                    m);
+        for (auto j : update_cost(current_j,
+                                  costs,
+                                  parents,
+                                  candidates,
+                                  jobs,
+                                  context.job_costs)) {
+          candidates.update(j, score(j));
+        }
       }
+    }
 
-      std::pop_heap(candidates.begin(), candidates.end(), eval_lambda);
-      candidates.pop_back();
+    for (auto j : last_chances[v]) {
+      if (!assigned[j]) {
+        ++nb_dropped;
+      }
     }
   }
 }
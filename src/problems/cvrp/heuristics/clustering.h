@@ -11,24 +11,68 @@ All rights reserved (see LICENSE).
 */
 
 #include <algorithm>
-#include <unordered_set>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <vector>
 
+#include "../../../structures/abstract/indexed_heap.h"
 #include "../../../structures/vroom/amount.h"
 #include "../../../structures/vroom/input/input.h"
 #include "../../../structures/vroom/job.h"
 
+class clustering_context;
+
 // Clustering types.
 enum class CLUSTERING_T { PARALLEL, SEQUENTIAL };
 
 // Initialization types.
 enum class INIT_T { NONE, HIGHER_AMOUNT, NEAREST };
 
+// K best (unassigned, edges_cost) outcomes among completed
+// clusterings, shared by concurrent runs so that they can stop as
+// soon as they provably can't make it to the k best. Both values are
+// packed in a single integer so that lexicographic comparison is
+// integer comparison.
+class clustering_bound {
+private:
+  const std::size_t _k;
+  std::mutex _outcomes_mutex;
+  // Sorted packed outcomes.
+  std::vector<uint64_t> _outcomes;
+  // Worst of the k best outcomes once k runs are completed.
+  std::atomic<uint64_t> _threshold;
+
+  static uint64_t pack(std::size_t nb_unassigned, cost_t cost);
+
+public:
+  clustering_bound(std::size_t k = 1);
+
+  // Whether an outcome with nb_unassigned unassigned jobs and given
+  // cost is strictly worse than the k best completed ones.
+  bool dominates(std::size_t nb_unassigned, cost_t cost) const;
+
+  void update(std::size_t nb_unassigned, cost_t cost);
+};
+
 class clustering {
 private:
   const input& input_ref;
-  void parallel_clustering();
-  void sequential_clustering();
+  // Assignment status for all job ranks.
+  std::vector<bool> assigned;
+  std::size_t nb_assigned;
+
+  // Whether this run can't beat bound any more, given the number of
+  // jobs that can't be assigned at this stage.
+  bool is_dominated(const clustering_context& context,
+                    const clustering_bound& bound,
+                    std::size_t nb_dropped) const;
+  void assign(index_t v, index_t j, cost_t cost);
+
+  void parallel_clustering(const clustering_context& context,
+                           const clustering_bound& bound);
+  void sequential_clustering(const clustering_context& context,
+                             const clustering_bound& bound);
 
 public:
   const CLUSTERING_T type;
@@ -37,9 +81,18 @@ public:
   std::vector<std::vector<index_t>> clusters;
   // Cost of all edges added during the clustering process
   cost_t edges_cost;
-  std::unordered_set<unsigned> unassigned;
+  // Ranks of unassigned jobs, in increasing order.
+  std::vector<index_t> unassigned;
+  // Whether the run stopped early as it could not beat the best
+  // completed clustering, in which case the above is partial.
+  bool aborted;
 
-  clustering(const input& input, CLUSTERING_T t, INIT_T i, double c);
+  // Completed runs update bound.
+  clustering(const clustering_context& context,
+             clustering_bound& bound,
+             CLUSTERING_T t,
+             INIT_T i,
+             double c);
 };
 
 #endif
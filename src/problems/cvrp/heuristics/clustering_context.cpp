@@ -0,0 +1,172 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include "../../../utils/helpers.h"
+#include "clustering_context.h"
+
+clustering_context::clustering_context(const input& input,
+                                       unsigned nb_threads)
+  : input_ref(input),
+    job_costs(input._jobs.size()),
+    candidates(input._vehicles.size()),
+    costs(input._vehicles.size(),
+          std::vector<cost_t>(input._jobs.size(),
+                              std::numeric_limits<cost_t>::max())),
+    parents(input._vehicles.size(),
+            std::vector<index_t>(input._jobs.size())),
+    top_costs(input._jobs.size()),
+    vehicles_to_job_costs(input._vehicles.size(),
+                          std::vector<cost_t>(input._jobs.size())),
+    sequential_regrets(input._vehicles.size(),
+                       std::vector<cost_t>(input._jobs.size(), 0)),
+    additions_lower_bounds(input._jobs.size() + 1, 0) {
+  const auto V = input._vehicles.size();
+  const auto J = input._jobs.size();
+  const auto& jobs = input._jobs;
+  const auto& vehicles = input._vehicles;
+  const auto& m = input.get_matrix();
+
+  // Per-vehicle rows only depend on the vehicle at hand.
+  parallel_ranges(V, nb_threads, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t v = begin; v < end; ++v) {
+      for (std::size_t j = 0; j < J; ++j) {
+        if (input._vehicle_to_job_compatibility[v][j]) {
+          candidates[v].push_back(j);
+        }
+      }
+
+      // Cost of reaching candidates from start, then from end when
+      // it differs.
+      auto update_cost = [&](index_t from_index) {
+        for (auto j : candidates[v]) {
+          auto current_cost = std::min(m[from_index][jobs[j].index()],
+                                       m[jobs[j].index()][from_index]);
+          if (current_cost < costs[v][j]) {
+            costs[v][j] = current_cost;
+            parents[v][j] = from_index;
+          }
+        }
+      };
+      if (vehicles[v].has_start()) {
+        auto start_index = vehicles[v].start.get().index();
+        update_cost(start_index);
+
+        if (vehicles[v].has_end()) {
+          auto end_index = vehicles[v].end.get().index();
+          if (start_index != end_index) {
+            update_cost(end_index);
+          }
+        }
+      } else {
+        assert(vehicles[v].has_end());
+        update_cost(vehicles[v].end.get().index());
+      }
+
+      for (std::size_t j = 0; j < J; ++j) {
+        cost_t current_cost = std::numeric_limits<cost_t>::max();
+        if (vehicles[v].has_start()) {
+          auto start_index = vehicles[v].start.get().index();
+          current_cost =
+            std::min(current_cost, m[start_index][jobs[j].index()]);
+        }
+        if (vehicles[v].has_end()) {
+          auto end_index = vehicles[v].end.get().index();
+          current_cost = std::min(current_cost, m[jobs[j].index()][end_index]);
+        }
+        vehicles_to_job_costs[v][j] = current_cost;
+      }
+    }
+  });
+
+  // Costs from vehicles that can't handle a job are irrelevant to
+  // regrets.
+  parallel_ranges(J, nb_threads, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t j = begin; j < end; ++j) {
+      for (std::size_t v = 0; v < V; ++v) {
+        if (costs[v][j] != std::numeric_limits<cost_t>::max()) {
+          top_costs[j].update(v, costs[v][j]);
+        }
+      }
+    }
+  });
+
+  // Regret for penultimate vehicle is the cost for last vehicle.
+  // Previous values are computed backward, independently for each
+  // job.
+  if (V > 1) {
+    parallel_ranges(J, nb_threads, [&](std::size_t begin, std::size_t end) {
+      for (std::size_t j = begin; j < end; ++j) {
+        sequential_regrets[V - 2][j] = vehicles_to_job_costs[V - 1][j];
+      }
+      for (std::size_t i = 3; i <= V; ++i) {
+        for (std::size_t j = begin; j < end; ++j) {
+          sequential_regrets[V - i][j] =
+            std::min(sequential_regrets[V - i + 1][j],
+                     vehicles_to_job_costs[V - i + 1][j]);
+        }
+      }
+    });
+  }
+
+  // Rows are filled one tile at a time, so that reading costs in the
+  // backward direction does not stride across the whole matrix for
+  // each job.
+  constexpr std::size_t T = JOB_COSTS_TILE_SIZE;
+  const std::size_t nb_tiles = (J + T - 1) / T;
+  parallel_ranges(nb_tiles,
+                  nb_threads,
+                  [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t bi = begin * T; bi < std::min(end * T, J);
+                         bi += T) {
+                      const auto ei = std::min(bi + T, J);
+                      for (std::size_t bj = 0; bj < J; bj += T) {
+                        const auto ej = std::min(bj + T, J);
+                        for (std::size_t i = bi; i < ei; ++i) {
+                          const auto& forward = m[jobs[i].index()];
+                          auto& row = job_costs[i];
+                          for (std::size_t j = bj; j < ej; ++j) {
+                            row[j] = std::min(forward[jobs[j].index()],
+                                              m[jobs[j].index()]
+                                               [jobs[i].index()]);
+                          }
+                        }
+                      }
+                    }
+                  });
+
+  // Any job addition uses an edge from a vehicle start or end or
+  // from another job. Minimums over rows are plain reductions over
+  // contiguous memory, vectorized by the compiler.
+  std::vector<cost_t> addition_costs(J);
+  parallel_ranges(J, nb_threads, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t j = begin; j < end; ++j) {
+      const cost_t* row = &job_costs[j][0];
+      cost_t cost = top_costs[j].best;
+      for (std::size_t i = 0; i < j; ++i) {
+        cost = std::min(cost, row[i]);
+      }
+      for (std::size_t i = j + 1; i < J; ++i) {
+        cost = std::min(cost, row[i]);
+      }
+      addition_costs[j] = cost;
+    }
+  });
+
+  std::sort(addition_costs.begin(), addition_costs.end());
+  uint64_t sum = 0;
+  for (std::size_t k = 0; k < J; ++k) {
+    sum += addition_costs[k];
+    additions_lower_bounds[k + 1] = static_cast<cost_t>(
+      std::min<uint64_t>(sum, std::numeric_limits<cost_t>::max()));
+  }
+}
@@ -0,0 +1,90 @@
+#ifndef CLUSTERING_CONTEXT_H
+#define CLUSTERING_CONTEXT_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <limits>
+#include <vector>
+
+#include "../../../structures/abstract/matrix.h"
+#include "../../../structures/vroom/input/input.h"
+
+// Side of the square tiles used to read costs in both directions
+// when building clustering_context::job_costs.
+constexpr std::size_t JOB_COSTS_TILE_SIZE = 32;
+
+// Two cheapest costs of reaching a job from any cluster, along with
+// the cluster reaching it the cheapest way. The regret for a cluster
+// is the cheapest cost from another one.
+struct top_two_costs {
+  cost_t best;
+  cost_t second_best;
+  index_t best_v;
+
+  top_two_costs()
+    : best(std::numeric_limits<cost_t>::max()),
+      second_best(std::numeric_limits<cost_t>::max()),
+      best_v(std::numeric_limits<index_t>::max()) {
+  }
+
+  cost_t regret(index_t v) const {
+    return (v == best_v) ? second_best : best;
+  }
+
+  // Account for the cost from cluster v decreasing to cost, or being
+  // set initially.
+  void update(index_t v, cost_t cost) {
+    if (v == best_v) {
+      best = cost;
+    } else if (cost < best) {
+      second_best = best;
+      best = cost;
+      best_v = v;
+    } else if (cost < second_best) {
+      second_best = cost;
+    }
+  }
+};
+
+// Initial data shared by all clustering runs, only depending on
+// input. Computed once, then only read by concurrent clusterings
+// that copy the parts they need to update.
+class clustering_context {
+public:
+  const input& input_ref;
+  // Job_costs[i][j] is the cost between jobs[i] and jobs[j] in the
+  // cheapest direction, so that costs from a job are read along a
+  // contiguous row.
+  matrix<cost_t> job_costs;
+  // Ranks of jobs compatible with each vehicle.
+  std::vector<std::vector<index_t>> candidates;
+  // Cheapest cost between each vehicle start or end and each job,
+  // in either direction, along with the matching start or end index
+  // as parent. Cost is the max value for incompatible jobs.
+  std::vector<std::vector<cost_t>> costs;
+  std::vector<std::vector<index_t>> parents;
+  // Two cheapest costs of reaching each job from compatible
+  // vehicles, from which regrets are derived.
+  std::vector<top_two_costs> top_costs;
+  // Cost of reaching jobs from vehicle start or of going from jobs
+  // to vehicle end, whichever is cheaper.
+  std::vector<std::vector<cost_t>> vehicles_to_job_costs;
+  // Sequential_regrets[v][j] is the min cost of reaching jobs[j] from
+  // any vehicle after v.
+  std::vector<std::vector<cost_t>> sequential_regrets;
+  // Additions_lower_bounds[k] is a lower bound on the cost of adding
+  // any k jobs to clusters, i.e. the sum of the k smallest costs of
+  // reaching a job from any other location.
+  std::vector<cost_t> additions_lower_bounds;
+
+  clustering_context(const input& input, unsigned nb_threads);
+};
+
+#endif
@@ -0,0 +1,257 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <boost/log/trivial.hpp>
+
+#include "clustering_context.h"
+#include "clustering_portfolio.h"
+
+clustering_portfolio::clustering_portfolio()
+  : _parameters({{CLUSTERING_T::PARALLEL, INIT_T::NONE, 0},
+                 {CLUSTERING_T::PARALLEL, INIT_T::NONE, 0.5},
+                 {CLUSTERING_T::PARALLEL, INIT_T::NONE, 1},
+                 {CLUSTERING_T::PARALLEL, INIT_T::NEAREST, 0},
+                 {CLUSTERING_T::PARALLEL, INIT_T::NEAREST, 0.5},
+                 {CLUSTERING_T::PARALLEL, INIT_T::NEAREST, 1},
+                 {CLUSTERING_T::PARALLEL, INIT_T::HIGHER_AMOUNT, 0},
+                 {CLUSTERING_T::PARALLEL, INIT_T::HIGHER_AMOUNT, 0.5},
+                 {CLUSTERING_T::PARALLEL, INIT_T::HIGHER_AMOUNT, 1},
+                 {CLUSTERING_T::SEQUENTIAL, INIT_T::NONE, 0},
+                 {CLUSTERING_T::SEQUENTIAL, INIT_T::NONE, 0.5},
+                 {CLUSTERING_T::SEQUENTIAL, INIT_T::NONE, 1},
+                 {CLUSTERING_T::SEQUENTIAL, INIT_T::NEAREST, 0},
+                 {CLUSTERING_T::SEQUENTIAL, INIT_T::NEAREST, 0.5},
+                 {CLUSTERING_T::SEQUENTIAL, INIT_T::NEAREST, 1},
+                 {CLUSTERING_T::SEQUENTIAL, INIT_T::HIGHER_AMOUNT, 0},
+                 {CLUSTERING_T::SEQUENTIAL, INIT_T::HIGHER_AMOUNT, 0.5},
+                 {CLUSTERING_T::SEQUENTIAL, INIT_T::HIGHER_AMOUNT, 1}}) {
+}
+
+// Exclusive lock on a file for as long as the object lives, used to
+// serialize statistics updates across processes.
+struct file_lock {
+  int fd;
+
+  file_lock(const std::string& file)
+    : fd(open(file.c_str(), O_RDWR | O_CREAT, 0644)) {
+    if (fd != -1) {
+      flock(fd, LOCK_EX);
+    }
+  }
+
+  ~file_lock() {
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+};
+
+clustering_portfolio& clustering_portfolio::shared() {
+  static clustering_portfolio portfolio;
+  return portfolio;
+}
+
+std::string clustering_portfolio::features(const clustering_context& context) {
+  const auto& jobs = context.input_ref._jobs;
+  const auto& vehicles = context.input_ref._vehicles;
+  const auto J = jobs.size();
+  const auto V = vehicles.size();
+
+  // Jobs per vehicle, on a log scale.
+  double ratio =
+    std::max(1.0, static_cast<double>(J) / std::max<std::size_t>(V, 1));
+  auto ratio_bucket = std::min(7, static_cast<int>(std::log2(ratio)));
+
+  // Overall amount over overall capacity, for the tightest
+  // dimension.
+  double tightness = 0;
+  auto amount_size = vehicles.empty() ? 0 : vehicles[0].capacity.get().size();
+  for (std::size_t d = 0; d < amount_size; ++d) {
+    double amount = 0;
+    for (const auto& j : jobs) {
+      amount += j.amount.get()[d];
+    }
+    double capacity = 0;
+    for (const auto& v : vehicles) {
+      capacity += v.capacity.get()[d];
+    }
+    if (capacity > 0) {
+      tightness = std::max(tightness, amount / capacity);
+    }
+  }
+  int tightness_bucket = 3;
+  if (tightness < 0.5) {
+    tightness_bucket = 0;
+  } else if (tightness < 0.8) {
+    tightness_bucket = 1;
+  } else if (tightness < 0.95) {
+    tightness_bucket = 2;
+  }
+
+  // Share of compatible vehicle/job pairs.
+  std::size_t nb_compatible = 0;
+  for (const auto& c : context.candidates) {
+    nb_compatible += c.size();
+  }
+  int skills_bucket = 0;
+  if (nb_compatible == J * V) {
+    skills_bucket = 2;
+  } else if (2 * nb_compatible >= J * V) {
+    skills_bucket = 1;
+  }
+
+  return "r" + std::to_string(ratio_bucket) + "-t" +
+         std::to_string(tightness_bucket) + "-s" +
+         std::to_string(skills_bucket);
+}
+
+void clustering_portfolio::load(const std::string& file) {
+  _file = file;
+  _stats.clear();
+
+  // Each line holds features then wins for all parameters, then
+  // runs for all parameters. Runs default to wins for lines only
+  // holding wins. Missing files and lines not matching current
+  // parameters are ignored.
+  std::ifstream in(file);
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream line_stream(line);
+    std::string features;
+    std::vector<unsigned> values;
+    unsigned value;
+    line_stream >> features;
+    while (line_stream >> value) {
+      values.push_back(value);
+    }
+    const auto P = _parameters.size();
+    if (features.empty() or
+        (values.size() != P and values.size() != 2 * P)) {
+      continue;
+    }
+    auto& stats = _stats[features];
+    stats.wins.assign(values.begin(), values.begin() + P);
+    if (values.size() == 2 * P) {
+      stats.runs.assign(values.begin() + P, values.end());
+    } else {
+      stats.runs = stats.wins;
+    }
+  }
+}
+
+void clustering_portfolio::save() const {
+  const auto tmp_file = _file + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream out(tmp_file);
+    for (const auto& features_stats : _stats) {
+      out << features_stats.first;
+      for (auto w : features_stats.second.wins) {
+        out << " " << w;
+      }
+      for (auto r : features_stats.second.runs) {
+        out << " " << r;
+      }
+      out << "\n";
+    }
+    out.close();
+    if (out and std::rename(tmp_file.c_str(), _file.c_str()) == 0) {
+      return;
+    }
+  }
+  std::remove(tmp_file.c_str());
+  BOOST_LOG_TRIVIAL(info) << "[CVRP] Failed to save clustering statistics "
+                          << "to " << _file << ".";
+}
+
+clustering_portfolio::parameters_stats
+clustering_portfolio::stats(const std::string& features) const {
+  auto search = _stats.find(features);
+  if (search != _stats.end()) {
+    return search->second;
+  }
+  return {std::vector<unsigned>(_parameters.size(), 0),
+          std::vector<unsigned>(_parameters.size(), 0)};
+}
+
+std::vector<std::size_t>
+clustering_portfolio::ranks(const std::string& features,
+                            const std::string& file,
+                            std::size_t max_ranks) {
+  parameters_stats s;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (file != _file) {
+      load(file);
+    }
+    s = stats(features);
+  }
+  const auto& wins = s.wins;
+  const auto& runs = s.runs;
+
+  // Compare (wins + 1) / (runs + 2) shares, the share for untried
+  // parameters being 1/2.
+  std::vector<std::size_t> ranks(_parameters.size());
+  std::iota(ranks.begin(), ranks.end(), 0);
+  std::stable_sort(ranks.begin(), ranks.end(), [&](auto lhs, auto rhs) {
+    return static_cast<uint64_t>(wins[lhs] + 1) * (runs[rhs] + 2) >
+           static_cast<uint64_t>(wins[rhs] + 1) * (runs[lhs] + 2);
+  });
+
+  if (0 < max_ranks and max_ranks < ranks.size()) {
+    if (max_ranks > 1) {
+      auto last_slot = ranks.begin() + max_ranks - 1;
+      auto least_tried =
+        std::min_element(last_slot, ranks.end(), [&](auto lhs, auto rhs) {
+          return runs[lhs] < runs[rhs];
+        });
+      std::rotate(last_slot, least_tried, least_tried + 1);
+    }
+    ranks.resize(max_ranks);
+  }
+  return ranks;
+}
+
+void clustering_portfolio::record(const std::string& features,
+                                  const std::string& file,
+                                  const std::vector<std::size_t>& tried,
+                                  std::size_t winner) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  // Reload from file to account for solves from other processes
+  // since last load, holding a lock until the file is replaced.
+  std::unique_ptr<file_lock> f_lock;
+  if (!file.empty()) {
+    f_lock.reset(new file_lock(file + ".lock"));
+  }
+  if (file != _file or !file.empty()) {
+    load(file);
+  }
+  auto& stats = _stats[features];
+  stats.wins.resize(_parameters.size(), 0);
+  stats.runs.resize(_parameters.size(), 0);
+  for (auto rank : tried) {
+    ++stats.runs[rank];
+  }
+  ++stats.wins[winner];
+
+  if (!_file.empty()) {
+    save();
+  }
+}
@@ -0,0 +1,90 @@
+#ifndef CLUSTERING_PORTFOLIO_H
+#define CLUSTERING_PORTFOLIO_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "clustering.h"
+
+class clustering_context;
+
+struct clustering_parameters {
+  CLUSTERING_T type;
+  INIT_T init;
+  double regret_coeff;
+};
+
+// Statistics on which clustering parameters produce the retained
+// clustering, grouped by instance features, used to try the most
+// promising parameters first. Statistics are kept for the whole
+// process and optionally persisted to a file.
+class clustering_portfolio {
+private:
+  std::mutex _mutex;
+  const std::vector<clustering_parameters> _parameters;
+  struct parameters_stats {
+    // Number of times each parameters rank led to the retained
+    // clustering.
+    std::vector<unsigned> wins;
+    // Number of times each parameters rank was tried.
+    std::vector<unsigned> runs;
+  };
+
+  // File statistics were loaded from, empty if none.
+  std::string _file;
+  std::unordered_map<std::string, parameters_stats> _stats;
+
+  // Replace statistics with the ones from file.
+  void load(const std::string& file);
+
+  // Write statistics to a temporary file then move it in place, so
+  // that the file is never left partially written.
+  void save() const;
+
+  // Number of wins and runs, if any, for features.
+  parameters_stats stats(const std::string& features) const;
+
+public:
+  clustering_portfolio();
+
+  static clustering_portfolio& shared();
+
+  const std::vector<clustering_parameters>& parameters() const {
+    return _parameters;
+  }
+
+  // Bucketed ratio of jobs per vehicle, capacity tightness and share
+  // of compatible vehicle/job pairs.
+  static std::string features(const clustering_context& context);
+
+  // Parameters ranks ordered by decreasing share of wins when tried
+  // for features, smoothed so that untried parameters rank after
+  // parameters winning most of the time and before parameters
+  // usually beaten. Default order breaks ties. At most max_ranks ranks
+  // are returned, 0 meaning no limit. When capped to more than one
+  // rank, the last slot goes to the least tried parameters among the
+  // ones left out, so that all parameters keep a chance to win.
+  std::vector<std::size_t> ranks(const std::string& features,
+                                 const std::string& file,
+                                 std::size_t max_ranks);
+
+  // Record that parameters at tried ranks were run for features and
+  // that the one at winner rank led to the retained clustering.
+  void record(const std::string& features,
+              const std::string& file,
+              const std::vector<std::size_t>& tried,
+              std::size_t winner);
+};
+
+#endif
@@ -0,0 +1,123 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+#include <numeric>
+
+#include "assignment_patching.h"
+#include "../tour_cost.h"
+
+template <class Matrix>
+tour_t assignment_patching(const Matrix& m, arena& memory) {
+  // Solving the assignment problem provides a successor for each
+  // node with minimal total cost, the diagonal being set to
+  // INFINITE_COST. This is a lower bound of the tour cost, made of
+  // one or several disjoint cycles. The matching code works on a
+  // plain matrix.
+  matrix<cost_t> assignment_matrix(m.size());
+  for (index_t i = 0; i < m.size(); ++i) {
+    for (index_t j = 0; j < m.size(); ++j) {
+      assignment_matrix[i][j] = m(i, j);
+    }
+  }
+  arena_unordered_map<index_t, index_t> assignment =
+    minimum_weight_perfect_matching(assignment_matrix, memory);
+
+  std::vector<index_t> successors(m.size());
+  for (const auto& arc : assignment) {
+    successors[arc.first] = arc.second;
+  }
+
+  // Spot all cycles, each one being represented by one of its nodes
+  // and its length.
+  std::vector<bool> visited(m.size(), false);
+  std::vector<std::pair<index_t, index_t>> cycles;
+  for (index_t i = 0; i < m.size(); ++i) {
+    if (visited[i]) {
+      continue;
+    }
+    index_t length = 0;
+    index_t current = i;
+    do {
+      visited[current] = true;
+      ++length;
+      current = successors[current];
+    } while (current != i);
+    cycles.emplace_back(i, length);
+  }
+
+  BOOST_LOG_TRIVIAL(trace) << "* Assignment has " << cycles.size()
+                           << " cycle(s).";
+
+  // Patch all cycles into the longest one, starting with the longest
+  // remaining cycles. Patching cycle C into main cycle M means
+  // picking a in M and b in C then replacing arcs a -> succ(a) and b
+  // -> succ(b) with a -> succ(b) and b -> succ(a), at the smallest
+  // possible additional cost.
+  std::sort(cycles.begin(), cycles.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.second > rhs.second;
+  });
+
+  std::vector<index_t> main_nodes;
+  main_nodes.reserve(m.size());
+  index_t current = cycles.front().first;
+  do {
+    main_nodes.push_back(current);
+    current = successors[current];
+  } while (current != cycles.front().first);
+
+  for (std::size_t c = 1; c < cycles.size(); ++c) {
+    int64_t best_delta = std::numeric_limits<int64_t>::max();
+    index_t best_a = 0; // Dummy init, value never used.
+    index_t best_b = 0; // Dummy init, value never used.
+
+    index_t b = cycles[c].first;
+    do {
+      index_t succ_b = successors[b];
+      int64_t b_cost = m(b, succ_b);
+      for (auto a : main_nodes) {
+        index_t succ_a = successors[a];
+        int64_t delta = static_cast<int64_t>(m(a, succ_b)) + m(b, succ_a) -
+                        m(a, succ_a) - b_cost;
+        if (delta < best_delta) {
+          best_delta = delta;
+          best_a = a;
+          best_b = b;
+        }
+      }
+      b = succ_b;
+    } while (b != cycles[c].first);
+
+    // Add patched cycle nodes to the main cycle, then perform the
+    // exchange.
+    index_t node = cycles[c].first;
+    do {
+      main_nodes.push_back(node);
+      node = successors[node];
+    } while (node != cycles[c].first);
+
+    std::swap(successors[best_a], successors[best_b]);
+  }
+
+  tour_t tour;
+  tour.reserve(m.size());
+  current = 0;
+  do {
+    tour.push_back(current);
+    current = successors[current];
+  } while (current != 0);
+  assert(tour.size() == m.size());
+
+  return tour;
+}
+
+template tour_t assignment_patching(const round_trip_cost& m, arena& memory);
+template tour_t assignment_patching(const start_only_cost& m, arena& memory);
+template tour_t assignment_patching(const end_only_cost& m, arena& memory);
+template tour_t assignment_patching(const start_and_end_cost& m, arena& memory);
@@ -0,0 +1,26 @@
+#ifndef ASSIGNMENT_PATCHING_H
+#define ASSIGNMENT_PATCHING_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <boost/log/trivial.hpp>
+
+#include "../../../algorithms/munkres.h"
+#include "../../../structures/abstract/tour.h"
+
+// Construction heuristic for asymmetric problems: solve the
+// assignment problem on the matrix then patch the resulting cycles
+// into a single tour (Karp's patching). Matrix is either a plain
+// matrix or a cost policy. Temporary node-based containers are
+// allocated from memory.
+template <class Matrix>
+tour_t assignment_patching(const Matrix& m, arena& memory);
+
+#endif
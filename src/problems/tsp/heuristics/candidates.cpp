@@ -0,0 +1,58 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include "candidates.h"
+#include "../../../structures/abstract/matrix_view.h"
+
+template <class Matrix>
+std::vector<std::vector<index_t>> nearest_candidates(const Matrix& m,
+                                                     index_t k) {
+  const index_t n = m.size();
+  k = std::min<index_t>(k, (n > 0) ? n - 1 : 0);
+
+  std::vector<std::vector<index_t>> candidates(n);
+  std::vector<cost_t> costs;
+  costs.reserve(k + 1);
+
+  for (index_t i = 0; i < n; ++i) {
+    auto& current = candidates[i];
+    current.reserve(k + 1);
+    costs.clear();
+
+    // Keeping a sorted list of the k best values so far, a new value
+    // only requires work if it beats the current worst one.
+    for (index_t j = 0; j < n; ++j) {
+      if (j == i) {
+        continue;
+      }
+      const cost_t c = m(i, j);
+      if (current.size() == k and c >= costs.back()) {
+        continue;
+      }
+      std::size_t rank = current.size();
+      while (rank > 0 and c < costs[rank - 1]) {
+        --rank;
+      }
+      current.insert(current.begin() + rank, j);
+      costs.insert(costs.begin() + rank, c);
+      if (current.size() > k) {
+        current.pop_back();
+        costs.pop_back();
+      }
+    }
+  }
+
+  return candidates;
+}
+
+template std::vector<std::vector<index_t>>
+nearest_candidates(const matrix<cost_t>& m, index_t k);
+
+template std::vector<std::vector<index_t>>
+nearest_candidates(const matrix_view<cost_t>& m, index_t k);
@@ -0,0 +1,27 @@
+#ifndef CANDIDATES_H
+#define CANDIDATES_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <vector>
+
+#include "../../../structures/typedefs.h"
+
+// Number of nearest neighbours kept as candidates for each node in
+// sparse heuristics.
+constexpr index_t NB_CANDIDATES = 10;
+
+// For each node i, the (at most) k nodes j != i with the smallest
+// m(i, j) values, sorted by increasing cost.
+template <class Matrix>
+std::vector<std::vector<index_t>> nearest_candidates(const Matrix& m,
+                                                     index_t k);
+
+#endif
@@ -9,46 +9,30 @@ All rights reserved (see LICENSE).
 
 #include "christofides.h"
 
-std::list<index_t> christofides(const matrix<cost_t>& sym_matrix) {
-  // The eulerian sub-graph further used is made of a minimum spanning
-  // tree with a minimum weight perfect matching on its odd degree
-  // vertices.
-
-  // Compute symmetric graph from the matrix.
-  auto sym_graph = undirected_graph<cost_t>(sym_matrix);
-
-  BOOST_LOG_TRIVIAL(trace) << "* Graph has " << sym_graph.size() << " nodes.";
-
-  // Work on a minimum spanning tree seen as a graph.
-  auto mst_graph = minimum_spanning_tree(sym_graph);
-
-  // Getting minimum spanning tree of associated graph under the form
-  // of an adjacency list.
-  std::unordered_map<index_t, std::list<index_t>> adjacency_list =
-    mst_graph.get_adjacency_list();
-
-  // Getting odd degree vertices from the minimum spanning tree.
-  std::vector<index_t> mst_odd_vertices;
-  for (const auto& adjacency : adjacency_list) {
-    if (adjacency.second.size() % 2 == 1) {
-      mst_odd_vertices.push_back(adjacency.first);
-    }
+// Symmetric perfect matching from the minimum weight perfect matching
+// on sub_matrix, each pair being stored once from its smallest
+// index.
+arena_unordered_map<index_t, index_t>
+symmetric_matching(const matrix<cost_t>& sub_matrix,
+                   unsigned nb_threads,
+                   MATCHING_T matching_backend,
+                   arena& memory) {
+  if (matching_backend == MATCHING_T::AUTO) {
+    matching_backend = (sub_matrix.size() >= AUCTION_MATCHING_THRESHOLD)
+                         ? MATCHING_T::AUCTION
+                         : MATCHING_T::MUNKRES;
   }
-  BOOST_LOG_TRIVIAL(trace)
-    << "* " << mst_odd_vertices.size()
-    << " nodes with odd degree in the minimum spanning tree.";
-
-  // Getting corresponding matrix for the generated sub-graph.
-  matrix<cost_t> sub_matrix = sym_matrix.get_sub_matrix(mst_odd_vertices);
 
   // Computing minimum weight perfect matching.
-  std::unordered_map<index_t, index_t> mwpm =
-    minimum_weight_perfect_matching(sub_matrix);
+  arena_unordered_map<index_t, index_t> mwpm =
+    (matching_backend == MATCHING_T::AUCTION)
+      ? auction_assignment(sub_matrix, nb_threads, memory)
+      : minimum_weight_perfect_matching(sub_matrix, memory);
 
   // Storing those edges from mwpm that are coherent regarding
   // symmetry (y -> x whenever x -> y). Remembering the rest of them
   // for further use. Edges are not doubled in mwpm_final.
-  std::unordered_map<index_t, index_t> mwpm_final;
+  arena_unordered_map<index_t, index_t> mwpm_final(memory);
   std::vector<index_t> wrong_vertices;
 
   unsigned total_ok = 0;
@@ -63,11 +47,12 @@ std::list<index_t> christofides(const matrix<cost_t>& sym_matrix) {
   }
 
   if (!wrong_vertices.empty()) {
-    BOOST_LOG_TRIVIAL(trace) << "* Munkres: " << wrong_vertices.size()
+    BOOST_LOG_TRIVIAL(trace) << "* Matching: " << wrong_vertices.size()
                              << " useless nodes for symmetry.";
 
-    std::unordered_map<index_t, index_t> remaining_greedy_mwpm =
-      greedy_symmetric_approx_mwpm(sub_matrix.get_sub_matrix(wrong_vertices));
+    arena_unordered_map<index_t, index_t> remaining_greedy_mwpm =
+      greedy_symmetric_approx_mwpm(sub_matrix.get_sub_matrix(wrong_vertices),
+                                   memory);
 
     // Adding edges obtained with greedy algo for the missing vertices
     // in mwpm_final.
@@ -79,89 +64,220 @@ std::list<index_t> christofides(const matrix<cost_t>& sym_matrix) {
     }
   }
 
+  return mwpm_final;
+}
+
+// Tour from the eulerian circuit of the graph made of edges, skipping
+// vertices already visited.
+tour_t shortcut_eulerian_circuit(const std::vector<edge<cost_t>>& edges,
+                                 std::size_t nb_vertices) {
+  // Building Eulerian graph from the edges.
+  csr_graph eulerian_graph(edges, nb_vertices);
+  assert(eulerian_graph.size() >= 2);
+
+  // Hierholzer's algorithm.
+  std::vector<index_t> eulerian_path = eulerian_graph.eulerian_circuit(0);
+
+  // Shortcutting the eulerian path.
+  std::vector<bool> already_visited(nb_vertices, false);
+  tour_t tour;
+  tour.reserve(nb_vertices);
+  for (const auto vertex : eulerian_path) {
+    if (!already_visited[vertex]) {
+      already_visited[vertex] = true;
+      tour.push_back(vertex);
+    }
+  }
+  return tour;
+}
+
+template <class Matrix>
+tour_t christofides(const Matrix& sym_matrix,
+                    unsigned nb_threads,
+                    MATCHING_T matching_backend,
+                    arena& memory) {
+  // The eulerian sub-graph further used is made of a minimum spanning
+  // tree with a minimum weight perfect matching on its odd degree
+  // vertices.
+
+  BOOST_LOG_TRIVIAL(trace) << "* Graph has " << sym_matrix.size()
+                           << " nodes.";
+
+  // Minimum spanning tree computed directly on the matrix, as a
+  // parent array rooted at 0.
+  std::vector<index_t> mst_parents;
+  if (sym_matrix.size() >= PARALLEL_MST_THRESHOLD and
+      nb_threads >= PARALLEL_MST_MIN_THREADS) {
+    mst_parents =
+      parallel_minimum_spanning_tree_parents(sym_matrix, nb_threads);
+  } else {
+    mst_parents = minimum_spanning_tree_parents(sym_matrix);
+  }
+
+  std::vector<edge<cost_t>> mst_edges;
+  mst_edges.reserve(sym_matrix.size());
+  std::vector<index_t> degrees(sym_matrix.size(), 0);
+  for (index_t v = 1; v < mst_parents.size(); ++v) {
+    index_t p = mst_parents[v];
+    assert(sym_matrix(v, p) == sym_matrix(p, v));
+    mst_edges.emplace_back(p, v, sym_matrix(p, v));
+    ++degrees[p];
+    ++degrees[v];
+  }
+
+  // Getting odd degree vertices from the minimum spanning tree.
+  std::vector<index_t> mst_odd_vertices;
+  for (index_t v = 0; v < degrees.size(); ++v) {
+    if (degrees[v] % 2 == 1) {
+      mst_odd_vertices.push_back(v);
+    }
+  }
+  BOOST_LOG_TRIVIAL(trace)
+    << "* " << mst_odd_vertices.size()
+    << " nodes with odd degree in the minimum spanning tree.";
+
+  // Getting corresponding matrix for the generated sub-graph.
+  matrix<cost_t> sub_matrix(mst_odd_vertices.size());
+  for (index_t i = 0; i < mst_odd_vertices.size(); ++i) {
+    for (index_t j = 0; j < mst_odd_vertices.size(); ++j) {
+      sub_matrix[i][j] = sym_matrix(mst_odd_vertices[i], mst_odd_vertices[j]);
+    }
+  }
+
+  arena_unordered_map<index_t, index_t> mwpm_final =
+    symmetric_matching(sub_matrix, nb_threads, matching_backend, memory);
+
   // Building eulerian graph.
-  std::vector<edge<cost_t>> eulerian_graph_edges = mst_graph.get_edges();
+  std::vector<edge<cost_t>> eulerian_graph_edges = std::move(mst_edges);
 
   // Adding edges from minimum weight perfect matching (with the
-  // original vertices index). Edges appear twice in matching so we
-  // need to remember the one already added.
-  std::set<index_t> already_added;
+  // original vertices index).
   for (const auto& edge : mwpm_final) {
     index_t first_index = mst_odd_vertices[edge.first];
     index_t second_index = mst_odd_vertices[edge.second];
-    if (already_added.find(first_index) == already_added.end()) {
-      eulerian_graph_edges.emplace_back(first_index,
-                                        second_index,
-                                        sym_matrix[first_index][second_index]);
-      already_added.insert(second_index);
-    }
+    eulerian_graph_edges.emplace_back(first_index,
+                                      second_index,
+                                      sym_matrix(first_index, second_index));
   }
 
-  // Building Eulerian graph from the edges.
-  undirected_graph<cost_t> eulerian_graph(eulerian_graph_edges);
-  assert(eulerian_graph.size() >= 2);
+  return shortcut_eulerian_circuit(eulerian_graph_edges, sym_matrix.size());
+}
+
+template <class Matrix>
+tour_t sparse_christofides(const Matrix& sym_matrix,
+                           const std::vector<std::vector<index_t>>& candidates,
+                           unsigned nb_threads,
+                           MATCHING_T matching_backend,
+                           arena& memory) {
+  const index_t n = sym_matrix.size();
 
-  // Hierholzer's algorithm: building and joining closed tours with
-  // vertices that still have adjacent edges.
-  std::unordered_map<index_t, std::list<index_t>> eulerian_adjacency_list =
-    eulerian_graph.get_adjacency_list();
-
-  std::list<index_t> eulerian_path;
-  eulerian_path.push_back(eulerian_adjacency_list.begin()->first);
-
-  // Building and joining tours as long as necessary.
-  bool complete_tour;
-
-  do {
-    complete_tour = true; // presumed complete
-    std::list<index_t>::iterator new_tour_start;
-    // Finding first element of eulerian_path that still has an
-    // adjacent edge (if any).
-    for (auto vertex = eulerian_path.begin(); vertex != eulerian_path.end();
-         ++vertex) {
-      if (eulerian_adjacency_list[*vertex].size() > 0) {
-        new_tour_start = vertex;
-        complete_tour = false;
-        break;
+  // Candidate edges, each one only once.
+  std::vector<edge<cost_t>> candidate_edges;
+  candidate_edges.reserve(n * NB_CANDIDATES);
+  for (index_t i = 0; i < n; ++i) {
+    for (const auto j : candidates[i]) {
+      if (i < j or std::find(candidates[j].begin(), candidates[j].end(), i) ==
+                     candidates[j].end()) {
+        candidate_edges.emplace_back(i, j, sym_matrix(i, j));
       }
     }
+  }
+
+  std::vector<edge<cost_t>> mst_edges =
+    minimum_spanning_forest(std::move(candidate_edges), n);
+
+  if (mst_edges.size() + 1 < n) {
+    BOOST_LOG_TRIVIAL(trace) << "* Candidate graph is not connected, "
+                                "using dense christofides.";
+    return christofides(sym_matrix, nb_threads, matching_backend, memory);
+  }
+
+  std::vector<index_t> degrees(n, 0);
+  for (const auto& e : mst_edges) {
+    ++degrees[e.get_first_vertex()];
+    ++degrees[e.get_second_vertex()];
+  }
 
-    if (!complete_tour) {
-      // Add new tour to initial eulerian path and check again.
-      std::list<index_t> new_tour;
-      index_t initial_vertex = *new_tour_start;
-      index_t current_vertex = initial_vertex;
-      index_t next_vertex;
-      // Start building new tour.
-      do {
-        new_tour.push_back(current_vertex);
-        // Find next vertex from any adjacent edge and remove used edge.
-        next_vertex = eulerian_adjacency_list[current_vertex].front();
-        eulerian_adjacency_list[current_vertex].pop_front();
-        for (auto vertex = eulerian_adjacency_list[next_vertex].begin();
-             vertex != eulerian_adjacency_list[next_vertex].end();
-             ++vertex) {
-          if (*vertex == current_vertex) {
-            eulerian_adjacency_list[next_vertex].erase(vertex);
-            break;
-          }
-        }
-        current_vertex = next_vertex;
-      } while (current_vertex != initial_vertex);
-
-      // Adding new tour to existing eulerian path.
-      eulerian_path.insert(new_tour_start, new_tour.begin(), new_tour.end());
+  // Getting odd degree vertices from the minimum spanning tree.
+  std::vector<index_t> mst_odd_vertices;
+  for (index_t v = 0; v < n; ++v) {
+    if (degrees[v] % 2 == 1) {
+      mst_odd_vertices.push_back(v);
     }
-  } while (!complete_tour);
-
-  std::set<index_t> already_visited;
-  std::list<index_t> tour;
-  for (const auto& vertex : eulerian_path) {
-    auto ret = already_visited.insert(vertex);
-    if (ret.second) {
-      // Vertex not already visited.
-      tour.push_back(vertex);
+  }
+  BOOST_LOG_TRIVIAL(trace)
+    << "* " << mst_odd_vertices.size()
+    << " nodes with odd degree in the minimum spanning tree.";
+
+  // Greedy matching on edges between odd vertices that are among
+  // the nearest odd vertices of one another.
+  matrix_view<cost_t> odd_view(sym_matrix, mst_odd_vertices);
+  auto odd_candidates = nearest_candidates(odd_view, NB_CANDIDATES);
+
+  std::vector<std::tuple<cost_t, index_t, index_t>> odd_edges;
+  for (index_t i = 0; i < mst_odd_vertices.size(); ++i) {
+    for (const auto j : odd_candidates[i]) {
+      odd_edges.emplace_back(odd_view(i, j), std::min(i, j), std::max(i, j));
     }
   }
-  return tour;
+  std::sort(odd_edges.begin(), odd_edges.end());
+
+  std::vector<bool> matched(mst_odd_vertices.size(), false);
+  std::vector<edge<cost_t>> eulerian_graph_edges = std::move(mst_edges);
+  for (const auto& e : odd_edges) {
+    const index_t i = std::get<1>(e);
+    const index_t j = std::get<2>(e);
+    if (!matched[i] and !matched[j]) {
+      matched[i] = true;
+      matched[j] = true;
+      eulerian_graph_edges.emplace_back(mst_odd_vertices[i],
+                                        mst_odd_vertices[j],
+                                        std::get<0>(e));
+    }
+  }
+
+  // Odd vertices left aside by the greedy matching are matched using
+  // all edges between them.
+  std::vector<index_t> remaining;
+  for (index_t i = 0; i < mst_odd_vertices.size(); ++i) {
+    if (!matched[i]) {
+      remaining.push_back(mst_odd_vertices[i]);
+    }
+  }
+  BOOST_LOG_TRIVIAL(trace) << "* " << remaining.size()
+                           << " odd nodes left for dense matching.";
+
+  if (!remaining.empty()) {
+    matrix<cost_t> sub_matrix(remaining.size());
+    for (index_t i = 0; i < remaining.size(); ++i) {
+      for (index_t j = 0; j < remaining.size(); ++j) {
+        sub_matrix[i][j] = sym_matrix(remaining[i], remaining[j]);
+      }
+    }
+
+    for (const auto& edge : symmetric_matching(sub_matrix,
+                                               nb_threads,
+                                               matching_backend,
+                                               memory)) {
+      index_t first_index = remaining[edge.first];
+      index_t second_index = remaining[edge.second];
+      eulerian_graph_edges.emplace_back(first_index,
+                                        second_index,
+                                        sym_matrix(first_index, second_index));
+    }
+  }
+
+  return shortcut_eulerian_circuit(eulerian_graph_edges, n);
 }
+
+template tour_t christofides(const matrix<cost_t>& sym_matrix,
+                             unsigned nb_threads,
+                             MATCHING_T matching_backend,
+                             arena& memory);
+
+template tour_t
+sparse_christofides(const matrix<cost_t>& sym_matrix,
+                    const std::vector<std::vector<index_t>>& candidates,
+                    unsigned nb_threads,
+                    MATCHING_T matching_backend,
+                    arena& memory);
@@ -10,15 +10,55 @@ All rights reserved (see LICENSE).
 
 */
 
+#include <algorithm>
 #include <chrono>
 #include <random>
+#include <tuple>
 
 #include <boost/log/trivial.hpp>
 
+#include "../../../algorithms/auction.h"
+#include "../../../algorithms/boruvka.h"
 #include "../../../algorithms/kruskal.h"
 #include "../../../algorithms/munkres.h"
+#include "../../../algorithms/prim.h"
+#include "../../../structures/abstract/csr_graph.h"
+#include "../../../structures/abstract/matrix_view.h"
+#include "../../../structures/abstract/tour.h"
+#include "./candidates.h"
 
-// Implementing a variant of the Christofides heuristic.
-std::list<index_t> christofides(const matrix<cost_t>& sym_matrix);
+// The minimum spanning tree is computed with the parallel Borůvka
+// algorithm for problems of at least this size when enough threads
+// are available, as it does more work than Prim overall.
+constexpr index_t PARALLEL_MST_THRESHOLD = 2000;
+constexpr unsigned PARALLEL_MST_MIN_THREADS = 4;
+
+// Backends for the minimum weight perfect matching on odd degree
+// vertices. AUTO picks the auction algorithm from
+// AUCTION_MATCHING_THRESHOLD odd vertices and Munkres otherwise.
+enum class MATCHING_T { AUTO, MUNKRES, AUCTION };
+
+constexpr index_t AUCTION_MATCHING_THRESHOLD = 500;
+
+// Implementing a variant of the Christofides heuristic. Matrix is
+// either a plain matrix or a cost policy and has to be symmetric.
+// Temporary node-based containers are allocated from memory.
+template <class Matrix>
+tour_t christofides(const Matrix& sym_matrix,
+                    unsigned nb_threads,
+                    MATCHING_T matching_backend,
+                    arena& memory);
+
+// Variant working on a sparse graph made of candidate edges for the
+// minimum spanning tree, then matching odd vertices greedily among
+// their nearest odd vertices. Only odd vertices left unmatched are
+// matched with dense edges, and the dense version is used if the
+// candidate graph is not connected.
+template <class Matrix>
+tour_t sparse_christofides(const Matrix& sym_matrix,
+                           const std::vector<std::vector<index_t>>& candidates,
+                           unsigned nb_threads,
+                           MATCHING_T matching_backend,
+                           arena& memory);
 
 #endif
@@ -0,0 +1,132 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+#include "greedy.h"
+#include "../../../structures/abstract/matrix.h"
+
+template <class Matrix>
+tour_t greedy_edge(const Matrix& sym_matrix,
+                   const std::vector<std::vector<index_t>>& candidates) {
+  constexpr index_t NO_NEIGHBOUR = std::numeric_limits<index_t>::max();
+
+  const index_t n = sym_matrix.size();
+  tour_t tour;
+  tour.reserve(n);
+
+  // Candidate edges, each one only once.
+  std::vector<std::tuple<cost_t, index_t, index_t>> edges;
+  for (index_t i = 0; i < n; ++i) {
+    for (const auto j : candidates[i]) {
+      edges.emplace_back(sym_matrix(i, j), std::min(i, j), std::max(i, j));
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  // Path fragments: two neighbour slots per node and a union-find
+  // to detect cycles.
+  std::vector<std::array<index_t, 2>> neighbours(n,
+                                                 {NO_NEIGHBOUR, NO_NEIGHBOUR});
+  std::vector<index_t> representative(n);
+  std::iota(representative.begin(), representative.end(), 0);
+  auto find = [&](index_t x) {
+    while (representative[x] != x) {
+      representative[x] = representative[representative[x]];
+      x = representative[x];
+    }
+    return x;
+  };
+
+  for (const auto& e : edges) {
+    const index_t u = std::get<1>(e);
+    const index_t v = std::get<2>(e);
+    if (neighbours[u][1] != NO_NEIGHBOUR or neighbours[v][1] != NO_NEIGHBOUR) {
+      continue;
+    }
+    const index_t u_rep = find(u);
+    const index_t v_rep = find(v);
+    if (u_rep == v_rep) {
+      continue;
+    }
+    representative[v_rep] = u_rep;
+    neighbours[u][(neighbours[u][0] == NO_NEIGHBOUR) ? 0 : 1] = v;
+    neighbours[v][(neighbours[v][0] == NO_NEIGHBOUR) ? 0 : 1] = u;
+  }
+
+  // Free path ends, a single node path being listed once. Position
+  // in ends is stored for constant-time removal.
+  std::vector<index_t> ends;
+  std::vector<std::size_t> end_position(n);
+  for (index_t i = 0; i < n; ++i) {
+    if (neighbours[i][1] == NO_NEIGHBOUR) {
+      end_position[i] = ends.size();
+      ends.push_back(i);
+    }
+  }
+  assert(!ends.empty());
+
+  auto remove_end = [&](index_t i) {
+    const std::size_t position = end_position[i];
+    ends[position] = ends.back();
+    end_position[ends.back()] = position;
+    ends.pop_back();
+  };
+
+  // Walk paths, starting from the first end found.
+  index_t current = ends.front();
+  while (true) {
+    remove_end(current);
+    index_t previous = NO_NEIGHBOUR;
+    while (true) {
+      tour.push_back(current);
+      index_t next = (neighbours[current][0] != previous)
+                       ? neighbours[current][0]
+                       : neighbours[current][1];
+      if (next == NO_NEIGHBOUR) {
+        break;
+      }
+      previous = current;
+      current = next;
+    }
+    if (previous != NO_NEIGHBOUR) {
+      // Other end of a multi-node path.
+      remove_end(current);
+    }
+
+    if (ends.empty()) {
+      break;
+    }
+
+    // Jump to nearest free end.
+    index_t nearest = ends.front();
+    cost_t nearest_cost = std::numeric_limits<cost_t>::max();
+    for (const auto i : ends) {
+      const cost_t c = sym_matrix(current, i);
+      if (c < nearest_cost) {
+        nearest_cost = c;
+        nearest = i;
+      }
+    }
+    current = nearest;
+  }
+  assert(tour.size() == n);
+
+  return tour;
+}
+
+template tour_t
+greedy_edge(const matrix<cost_t>& sym_matrix,
+            const std::vector<std::vector<index_t>>& candidates);
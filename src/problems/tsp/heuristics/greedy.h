@@ -0,0 +1,25 @@
+#ifndef GREEDY_H
+#define GREEDY_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <vector>
+
+#include "../../../structures/abstract/tour.h"
+
+// Greedy edge heuristic restricted to candidate edges: cheapest
+// edges are added as long as they keep node degrees below 3 and
+// create no cycle. Resulting paths are then chained by jumping to
+// the nearest free path end. Matrix has to be symmetric.
+template <class Matrix>
+tour_t greedy_edge(const Matrix& sym_matrix,
+                   const std::vector<std::vector<index_t>>& candidates);
+
+#endif
@@ -0,0 +1,132 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "../tour_cost.h"
+#include "held_karp.h"
+
+template <class Matrix> tour_t held_karp(const Matrix& m, index_t start) {
+  // Values are stored as signed 64 bits integers so that sums of
+  // INFINITE_COST values never overflow.
+  using value_t = int64_t;
+  constexpr value_t NO_PATH = std::numeric_limits<value_t>::max() / 4;
+
+  const index_t n = m.size();
+  tour_t tour;
+  tour.reserve(n);
+  tour.push_back(start);
+  if (n < 2) {
+    return tour;
+  }
+
+  // Other nodes are relabelled from 0 to k - 1 so that subsets are
+  // bitmasks over k bits.
+  const index_t k = n - 1;
+  std::vector<index_t> nodes;
+  for (index_t i = 0; i < n; ++i) {
+    if (i != start) {
+      nodes.push_back(i);
+    }
+  }
+
+  // transposed_costs[j * k + i] is the cost from nodes[i] to
+  // nodes[j], so that all ways into j are contiguous.
+  std::vector<value_t> transposed_costs(k * k);
+  for (index_t j = 0; j < k; ++j) {
+    for (index_t i = 0; i < k; ++i) {
+      transposed_costs[j * k + i] = m(nodes[i], nodes[j]);
+    }
+  }
+
+  // best[S * k + j] is the cost of the cheapest path from start
+  // visiting all nodes in S and ending at j (in S). Values for j not
+  // in S stay at NO_PATH.
+  const uint32_t nb_subsets = 1u << k;
+  std::vector<value_t> best(static_cast<std::size_t>(nb_subsets) * k, NO_PATH);
+  for (index_t j = 0; j < k; ++j) {
+    best[(1u << j) * k + j] = m(start, nodes[j]);
+  }
+
+  for (uint32_t S = 1; S < nb_subsets; ++S) {
+    for (index_t j = 0; j < k; ++j) {
+      const uint32_t j_bit = 1u << j;
+      if (!(S & j_bit) or S == j_bit) {
+        continue;
+      }
+      // Branch-free minimum over all ways into j from the subset
+      // without j, values for nodes out of this subset being
+      // NO_PATH.
+      const value_t* previous = best.data() + (S ^ j_bit) * k;
+      const value_t* into_j = transposed_costs.data() + j * k;
+      value_t value = NO_PATH;
+      for (index_t i = 0; i < k; ++i) {
+        value = std::min(value, previous[i] + into_j[i]);
+      }
+      best[S * k + j] = std::min(value, NO_PATH);
+    }
+  }
+
+  // Close the tour back to start.
+  const uint32_t full = nb_subsets - 1;
+  index_t last = 0;
+  value_t best_value = NO_PATH;
+  for (index_t j = 0; j < k; ++j) {
+    const value_t value = best[full * k + j] + m(nodes[j], start);
+    if (value < best_value) {
+      best_value = value;
+      last = j;
+    }
+  }
+
+  // Backtrack from the last node by finding a predecessor matching
+  // the stored value.
+  std::vector<index_t> backward;
+  backward.reserve(k);
+  uint32_t S = full;
+  index_t current = last;
+  while (true) {
+    backward.push_back(nodes[current]);
+    const uint32_t previous_set = S ^ (1u << current);
+    if (previous_set == 0) {
+      break;
+    }
+    const value_t target = best[S * k + current];
+    index_t predecessor = k;
+    for (index_t i = 0; i < k; ++i) {
+      if ((previous_set & (1u << i)) and
+          best[previous_set * k + i] + transposed_costs[current * k + i] ==
+            target) {
+        predecessor = i;
+        break;
+      }
+    }
+    assert(predecessor < k);
+    S = previous_set;
+    current = predecessor;
+  }
+
+  for (auto step = backward.crbegin(); step != backward.crend(); ++step) {
+    tour.push_back(*step);
+  }
+  assert(tour.size() == n);
+
+  return tour;
+}
+
+template tour_t held_karp(const matrix<cost_t>& m, index_t start);
+
+template tour_t held_karp(const round_trip_cost& m, index_t start);
+template tour_t held_karp(const start_only_cost& m, index_t start);
+template tour_t held_karp(const end_only_cost& m, index_t start);
+template tour_t held_karp(const start_and_end_cost& m, index_t start);
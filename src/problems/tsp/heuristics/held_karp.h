@@ -0,0 +1,22 @@
+#ifndef HELD_KARP_H
+#define HELD_KARP_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include "../../../structures/abstract/tour.h"
+
+// Exact Held-Karp dynamic programming over subsets, in O(2^n * n^2)
+// time and O(2^n * n) memory so only usable for small problems.
+// Returns an optimal tour starting at start. Matrix is either a plain
+// matrix or a cost policy, so open tours are handled through the
+// costs.
+template <class Matrix> tour_t held_karp(const Matrix& m, index_t start);
+
+#endif
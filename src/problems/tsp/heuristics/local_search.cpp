@@ -8,43 +8,44 @@ All rights reserved (see LICENSE).
 */
 
 #include "local_search.h"
+#include "../tour_cost.h"
 
-local_search::local_search(const matrix<cost_t>& matrix,
-                           bool is_symmetric_matrix,
-                           const std::list<index_t>& tour,
-                           unsigned nb_threads)
+template <class Matrix>
+local_search<Matrix>::local_search(const Matrix& matrix,
+                                   bool is_symmetric_matrix,
+                                   const tour_t& tour,
+                                   task_executor& executor)
   : _matrix(matrix),
     _is_symmetric_matrix(is_symmetric_matrix),
     _edges(_matrix.size()),
-    _nb_threads(std::min(nb_threads, static_cast<unsigned>(tour.size()))),
-    _rank_limits(_nb_threads) {
+    _executor(executor),
+    _nb_ranges(std::min<std::size_t>(executor.size(),
+                                     1 + tour.size() / MIN_LOOK_UP_RANGE)),
+    _rank_limits(_nb_ranges),
+    _tour_order(_edges.size()),
+    _previous(_edges.size()),
+    _possible_position(_edges.size()),
+    _edges_copy(_edges.size()),
+    _previous_copy(_edges.size()) {
   // Build _edges vector representation.
-  auto location = tour.cbegin();
-  index_t first_index = *location;
-  index_t current_index = first_index;
-  index_t last_index = first_index;
-  ++location;
-  while (location != tour.cend()) {
-    current_index = *location;
-    _edges.at(last_index) = current_index;
-    last_index = current_index;
-    ++location;
+  for (std::size_t i = 0; i < tour.size() - 1; ++i) {
+    _edges.at(tour[i]) = tour[i + 1];
   }
-  _edges.at(last_index) = first_index;
+  _edges.at(tour.back()) = tour.front();
 
   // Build a vector of bounds that easily split the [0, _edges.size()]
-  // look-up range 'evenly' between threads for relocate and or-opt
+  // look-up range 'evenly' between ranges for relocate and or-opt
   // operator.
-  std::size_t range_width = _edges.size() / _nb_threads;
+  std::size_t range_width = _edges.size() / _nb_ranges;
   std::iota(_rank_limits.begin(), _rank_limits.end(), 0);
   std::transform(_rank_limits.begin(),
                  _rank_limits.end(),
                  _rank_limits.begin(),
                  [range_width](std::size_t v) { return range_width * v; });
   // Shifting the limits to dispatch remaining ranks among more
-  // threads for a more even load balance. This way the load
+  // ranges for a more even load balance. This way the load
   // difference between ranges should be at most 1.
-  std::size_t remainder = _edges.size() % _nb_threads;
+  std::size_t remainder = _edges.size() % _nb_ranges;
   std::size_t shift = 0;
   for (std::size_t i = 1; i < _rank_limits.size(); ++i) {
     if (shift < remainder) {
@@ -55,15 +56,15 @@ local_search::local_search(const matrix<cost_t>& matrix,
   _rank_limits.push_back(_edges.size());
 
   // Build a vector of bounds that easily split the [0, _edges.size()]
-  // look-up range 'evenly' between threads for 2-opt symmetric
+  // look-up range 'evenly' between ranges for 2-opt symmetric
   // operator.
   _sym_two_opt_rank_limits.push_back(0);
 
-  if (_nb_threads > 1) {
+  if (_nb_ranges > 1) {
     // When avoiding duplicate tests in two-opt (symmetric case), the
     // first choice for edge_1 requires number_of_lookups[0] checks
     // for edge_2, the next requires number_of_lookups[1] and so
-    // on. If several threads are used, splitting the share between
+    // on. If several ranges are used, splitting the share between
     // them is based on this workload.
 
     std::vector<unsigned> number_of_lookups(_edges.size() - 1);
@@ -76,11 +77,11 @@ local_search::local_search(const matrix<cost_t>& matrix,
                      std::back_inserter(cumulated_lookups));
 
     unsigned total_lookups = _edges.size() * (_edges.size() - 3) / 2;
-    unsigned thread_lookup_share = total_lookups / _nb_threads;
+    unsigned thread_lookup_share = total_lookups / _nb_ranges;
 
     index_t rank = 0;
-    for (std::size_t i = 1; i < _nb_threads; ++i) {
-      // Finding nodes that separate current tour in _nb_threads ranges.
+    for (std::size_t i = 1; i < _nb_ranges; ++i) {
+      // Finding nodes that separate current tour in _nb_ranges ranges.
       while (cumulated_lookups[rank] < i * thread_lookup_share) {
         ++rank;
       }
@@ -91,7 +92,21 @@ local_search::local_search(const matrix<cost_t>& matrix,
   _sym_two_opt_rank_limits.push_back(_edges.size());
 }
 
-cost_t local_search::relocate_step() {
+template <class Matrix>
+template <class Function>
+void local_search<Matrix>::run_look_ups(Function look_up) {
+  // Submit other ranges, keeping the last one for the current thread.
+  task_group group;
+  for (std::size_t i = 0; i < _nb_ranges - 1; ++i) {
+    _executor.submit(group, [&, i]() { look_up(i); });
+  }
+
+  look_up(_nb_ranges - 1);
+
+  _executor.wait(group);
+}
+
+template <class Matrix> cost_t local_search<Matrix>::relocate_step() {
   if (_edges.size() < 3) {
     // Not enough edges for the operator to make sense.
     return 0;
@@ -115,18 +130,18 @@ cost_t local_search::relocate_step() {
       index_t next = _edges.at(edge_1_end);
 
       // Precomputing weights not depending on edge_2_*.
-      cost_t first_potential_add = _matrix[edge_1_start][next];
-      cost_t edge_1_weight = _matrix[edge_1_start][edge_1_end];
-      cost_t edge_1_end_next_weight = _matrix[edge_1_end][next];
+      cost_t first_potential_add = _matrix(edge_1_start, next);
+      cost_t edge_1_weight = _matrix(edge_1_start, edge_1_end);
+      cost_t edge_1_end_next_weight = _matrix(edge_1_end, next);
 
       index_t edge_2_start = next;
       while (edge_2_start != edge_1_start) {
         index_t edge_2_end = _edges.at(edge_2_start);
         cost_t before_cost = edge_1_weight + edge_1_end_next_weight +
-                             _matrix[edge_2_start][edge_2_end];
+                             _matrix(edge_2_start, edge_2_end);
         cost_t after_cost = first_potential_add +
-                            _matrix[edge_2_start][edge_1_end] +
-                            _matrix[edge_1_end][edge_2_end];
+                            _matrix(edge_2_start, edge_1_end) +
+                            _matrix(edge_1_end, edge_2_end);
 
         if (before_cost > after_cost) {
           cost_t gain = before_cost - after_cost;
@@ -142,34 +157,20 @@ cost_t local_search::relocate_step() {
     }
   };
 
-  // Store best values per thread.
-  std::vector<cost_t> best_gains(_nb_threads, 0);
-  std::vector<index_t> best_edge_1_starts(_nb_threads);
-  std::vector<index_t> best_edge_2_starts(_nb_threads);
-
-  // Start other threads, keeping a piece of the range for the main
-  // thread.
-  std::vector<std::thread> threads;
-  for (std::size_t i = 0; i < _nb_threads - 1; ++i) {
-    threads.emplace_back(look_up,
-                         _rank_limits[i],
-                         _rank_limits[i + 1],
-                         std::ref(best_gains[i]),
-                         std::ref(best_edge_1_starts[i]),
-                         std::ref(best_edge_2_starts[i]));
-  }
-
-  look_up(_rank_limits[_nb_threads - 1],
-          _rank_limits[_nb_threads],
-          std::ref(best_gains[_nb_threads - 1]),
-          std::ref(best_edge_1_starts[_nb_threads - 1]),
-          std::ref(best_edge_2_starts[_nb_threads - 1]));
+  // Store best values per range.
+  std::vector<cost_t> best_gains(_nb_ranges, 0);
+  std::vector<index_t> best_edge_1_starts(_nb_ranges);
+  std::vector<index_t> best_edge_2_starts(_nb_ranges);
 
-  for (auto& t : threads) {
-    t.join();
-  }
+  run_look_ups([&](std::size_t i) {
+    look_up(_rank_limits[i],
+            _rank_limits[i + 1],
+            best_gains[i],
+            best_edge_1_starts[i],
+            best_edge_2_starts[i]);
+  });
 
-  // Spot best gain found among all threads.
+  // Spot best gain found among all ranges.
   auto best_rank =
     std::distance(best_gains.begin(),
                   std::max_element(best_gains.begin(), best_gains.end()));
@@ -190,7 +191,8 @@ cost_t local_search::relocate_step() {
   return best_gain;
 }
 
-cost_t local_search::perform_all_relocate_steps() {
+template <class Matrix>
+cost_t local_search<Matrix>::perform_all_relocate_steps() {
   cost_t total_gain = 0;
   unsigned relocate_iter = 0;
   cost_t gain = 0;
@@ -211,7 +213,7 @@ cost_t local_search::perform_all_relocate_steps() {
   return total_gain;
 }
 
-cost_t local_search::avoid_loop_step() {
+template <class Matrix> cost_t local_search<Matrix>::avoid_loop_step() {
   // In some cases, the solution can contain "loops" that other
   // operators can't fix. Those are found with two steps:
   //
@@ -227,110 +229,130 @@ cost_t local_search::avoid_loop_step() {
 
   cost_t gain = 0;
 
-  // Going through all candidate nodes for relocation.
+  // Going through all candidate nodes for relocation in the order of
+  // the current tour, starting after node 0 which is the last rank
+  // and is not a candidate. Remember previous steps for each node,
+  // required for step 3.
   index_t previous_candidate = 0;
-  index_t candidate = _edges.at(previous_candidate);
-
-  // Remember previous steps for each node, required for step 3.
-  std::vector<index_t> previous(_matrix.size());
-  previous.at(candidate) = previous_candidate;
-
-  // Storing chains as described in 2.
-  std::vector<std::list<index_t>> relocatable_chains;
-  std::list<index_t> current_relocatable_chain;
-
-  // Remember possible position for further relocation of candidate
-  // nodes.
-  std::unordered_map<index_t, index_t> possible_position;
-
-  do {
-    index_t current = _edges.at(candidate);
-
-    bool candidate_relocatable = false;
-    while ((current != previous_candidate) and !candidate_relocatable) {
-      index_t next = _edges.at(current);
-      if ((_matrix[current][candidate] + _matrix[candidate][next] <=
-           _matrix[current][next]) and
-          (_matrix[current][candidate] > 0) and
-          (_matrix[candidate][next] > 0)) {
-        // Relocation at no cost, set aside the case of identical
-        // locations.
-        candidate_relocatable = true;
-        // Remember possible relocate position for candidate.
-        possible_position.emplace(candidate, current);
+  for (std::size_t rank = 0; rank < _edges.size(); ++rank) {
+    index_t candidate = _edges[previous_candidate];
+    _tour_order[rank] = candidate;
+    _previous[candidate] = previous_candidate;
+    previous_candidate = candidate;
+  }
+  index_t last_candidate_rank = _edges.size() - 1;
+
+  // Lambda function to spot candidates in a range of ranks from
+  // _tour_order, remembering possible position for further
+  // relocation. A candidate that can't be relocated at no cost is
+  // its own possible position.
+  auto look_up = [&](index_t start, index_t end) {
+    end = std::min(end, last_candidate_rank);
+    for (index_t rank = start; rank < end; ++rank) {
+      index_t candidate = _tour_order[rank];
+      index_t before_candidate = _previous[candidate];
+      _possible_position[candidate] = candidate;
+
+      index_t current = _edges[candidate];
+      while (current != before_candidate) {
+        index_t next = _edges[current];
+        if ((_matrix(current, candidate) + _matrix(candidate, next) <=
+             _matrix(current, next)) and
+            (_matrix(current, candidate) > 0) and
+            (_matrix(candidate, next) > 0)) {
+          // Relocation at no cost, set aside the case of identical
+          // locations.
+          _possible_position[candidate] = current;
+          break;
+        }
+        current = next;
       }
-      current = next;
     }
-    if (candidate_relocatable) {
-      current_relocatable_chain.push_back(candidate);
+  };
+
+  run_look_ups(
+    [&](std::size_t i) { look_up(_rank_limits[i], _rank_limits[i + 1]); });
+
+  // Storing chains as described in 2 as (first rank in _tour_order,
+  // length) pairs.
+  _relocatable_chains.clear();
+  index_t chain_start = 0;
+  index_t chain_length = 0;
+  for (index_t rank = 0; rank < last_candidate_rank; ++rank) {
+    index_t candidate = _tour_order[rank];
+    if (_possible_position[candidate] != candidate) {
+      if (chain_length == 0) {
+        chain_start = rank;
+      }
+      ++chain_length;
     } else {
-      if (current_relocatable_chain.size() > 1) {
-        relocatable_chains.push_back(current_relocatable_chain);
+      if (chain_length > 1) {
+        _relocatable_chains.emplace_back(chain_start, chain_length);
       }
-      current_relocatable_chain.clear();
+      chain_length = 0;
     }
-    previous_candidate = candidate;
-    candidate = _edges.at(candidate);
-    previous.at(candidate) = previous_candidate;
-  } while (candidate != 0);
+  }
 
   // Reorder to try the longest chains first.
-  std::sort(relocatable_chains.begin(),
-            relocatable_chains.end(),
-            [](const std::list<index_t>& lhs, const std::list<index_t>& rhs) {
-              return lhs.size() > rhs.size();
+  std::sort(_relocatable_chains.begin(),
+            _relocatable_chains.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return lhs.second > rhs.second;
             });
 
   bool amelioration_found = false;
-  for (auto const& chain : relocatable_chains) {
+  for (auto const& chain : _relocatable_chains) {
     // Going through step 3. for all chains by decreasing length.
     cost_t before_cost = 0;
     cost_t after_cost = 0;
 
     // Work on copies as modifications are needed while going through
-    // the chain.
-    std::vector<index_t> edges_c = _edges;
-    std::vector<index_t> previous_c = previous;
+    // the chain. Buffers have the right size so this never allocates.
+    _edges_copy = _edges;
+    _previous_copy = _previous;
+
+    for (index_t rank = chain.first; rank < chain.first + chain.second;
+         ++rank) {
+      index_t step = _tour_order[rank];
+      index_t position = _possible_position[step];
 
-    for (auto const& step : chain) {
       // Compare situations to see if relocating current step after
-      // possible_position.at(step) will decrease overall cost.
+      // position will decrease overall cost.
       //
       // Situation before:
       //
-      // previous_c.at(step)-->step-->edges_c.at(step)
-      // possible_position.at(step)-->edges_c.at(possible_position.at(step))
+      // _previous_copy.at(step)-->step-->_edges_copy.at(step)
+      // position-->_edges_copy.at(position)
       //
       // Situation after:
       //
-      // previous_c.at(step)-->edges_c.at(step)
-      // possible_position.at(step)-->step-->edges_c.at(possible_position.at(step))
-
-      before_cost += _matrix[previous_c.at(step)][step];
-      before_cost += _matrix[step][edges_c.at(step)];
-      after_cost += _matrix[previous_c.at(step)][edges_c.at(step)];
-      before_cost += _matrix[possible_position.at(step)]
-                            [edges_c.at(possible_position.at(step))];
-      after_cost += _matrix[possible_position.at(step)][step];
-      after_cost += _matrix[step][edges_c.at(possible_position.at(step))];
-
-      // Linking previous_c.at(step) with edges_c.at(step) in both
-      // ways as remembering previous nodes is required.
-      previous_c.at(edges_c.at(step)) = previous_c.at(step);
-      edges_c.at(previous_c.at(step)) = edges_c.at(step);
-
-      // Relocating step between possible_position.at(step) and
-      // edges_c.at(possible_position.at(step)) in both ways too.
-      edges_c.at(step) = edges_c.at(possible_position.at(step));
-      previous_c.at(edges_c.at(possible_position.at(step))) = step;
-
-      edges_c.at(possible_position.at(step)) = step;
-      previous_c.at(step) = possible_position.at(step);
+      // _previous_copy.at(step)-->_edges_copy.at(step)
+      // position-->step-->_edges_copy.at(position)
+
+      before_cost += _matrix(_previous_copy.at(step), step);
+      before_cost += _matrix(step, _edges_copy.at(step));
+      after_cost += _matrix(_previous_copy.at(step), _edges_copy.at(step));
+      before_cost += _matrix(position, _edges_copy.at(position));
+      after_cost += _matrix(position, step);
+      after_cost += _matrix(step, _edges_copy.at(position));
+
+      // Linking _previous_copy.at(step) with _edges_copy.at(step) in
+      // both ways as remembering previous nodes is required.
+      _previous_copy.at(_edges_copy.at(step)) = _previous_copy.at(step);
+      _edges_copy.at(_previous_copy.at(step)) = _edges_copy.at(step);
+
+      // Relocating step between position and
+      // _edges_copy.at(position) in both ways too.
+      _edges_copy.at(step) = _edges_copy.at(position);
+      _previous_copy.at(_edges_copy.at(position)) = step;
+
+      _edges_copy.at(position) = step;
+      _previous_copy.at(step) = position;
 
       if (before_cost > after_cost) {
         amelioration_found = true;
         gain = before_cost - after_cost;
-        _edges.swap(edges_c); // Keep changes.
+        _edges.swap(_edges_copy); // Keep changes.
         break;
       }
     }
@@ -342,7 +364,8 @@ cost_t local_search::avoid_loop_step() {
   return gain;
 }
 
-cost_t local_search::perform_all_avoid_loop_steps() {
+template <class Matrix>
+cost_t local_search<Matrix>::perform_all_avoid_loop_steps() {
   cost_t total_gain = 0;
   unsigned relocate_iter = 0;
   cost_t gain = 0;
@@ -363,7 +386,7 @@ cost_t local_search::perform_all_avoid_loop_steps() {
   return total_gain;
 }
 
-cost_t local_search::two_opt_step() {
+template <class Matrix> cost_t local_search<Matrix>::two_opt_step() {
   if (_edges.size() < 4) {
     // Not enough edges for the operator to make sense.
     return 0;
@@ -399,9 +422,9 @@ cost_t local_search::two_opt_step() {
         }
 
         cost_t before_cost =
-          _matrix[edge_1_start][edge_1_end] + _matrix[edge_2_start][edge_2_end];
+          _matrix(edge_1_start, edge_1_end) + _matrix(edge_2_start, edge_2_end);
         cost_t after_cost =
-          _matrix[edge_1_start][edge_2_start] + _matrix[edge_1_end][edge_2_end];
+          _matrix(edge_1_start, edge_2_start) + _matrix(edge_1_end, edge_2_end);
 
         if (before_cost > after_cost) {
           cost_t gain = before_cost - after_cost;
@@ -415,34 +438,20 @@ cost_t local_search::two_opt_step() {
     }
   };
 
-  // Store best values per thread.
-  std::vector<cost_t> best_gains(_nb_threads, 0);
-  std::vector<index_t> best_edge_1_starts(_nb_threads);
-  std::vector<index_t> best_edge_2_starts(_nb_threads);
-
-  // Start other threads, keeping a piece of the range for the main
-  // thread.
-  std::vector<std::thread> threads;
-  for (std::size_t i = 0; i < _nb_threads - 1; ++i) {
-    threads.emplace_back(look_up,
-                         _sym_two_opt_rank_limits[i],
-                         _sym_two_opt_rank_limits[i + 1],
-                         std::ref(best_gains[i]),
-                         std::ref(best_edge_1_starts[i]),
-                         std::ref(best_edge_2_starts[i]));
-  }
-
-  look_up(_sym_two_opt_rank_limits[_nb_threads - 1],
-          _sym_two_opt_rank_limits[_nb_threads],
-          std::ref(best_gains[_nb_threads - 1]),
-          std::ref(best_edge_1_starts[_nb_threads - 1]),
-          std::ref(best_edge_2_starts[_nb_threads - 1]));
+  // Store best values per range.
+  std::vector<cost_t> best_gains(_nb_ranges, 0);
+  std::vector<index_t> best_edge_1_starts(_nb_ranges);
+  std::vector<index_t> best_edge_2_starts(_nb_ranges);
 
-  for (auto& t : threads) {
-    t.join();
-  }
+  run_look_ups([&](std::size_t i) {
+    look_up(_sym_two_opt_rank_limits[i],
+            _sym_two_opt_rank_limits[i + 1],
+            best_gains[i],
+            best_edge_1_starts[i],
+            best_edge_2_starts[i]);
+  });
 
-  // Spot best gain found among all threads.
+  // Spot best gain found among all ranges.
   auto best_rank =
     std::distance(best_gains.begin(),
                   std::max_element(best_gains.begin(), best_gains.end()));
@@ -472,7 +481,7 @@ cost_t local_search::two_opt_step() {
   return best_gain;
 }
 
-cost_t local_search::asym_two_opt_step() {
+template <class Matrix> cost_t local_search<Matrix>::asym_two_opt_step() {
   if (_edges.size() < 4) {
     // Not enough edges for the operator to make sense.
     return 0;
@@ -512,14 +521,14 @@ cost_t local_search::asym_two_opt_step() {
         // (mandatory for before_cost and after_cost efficient
         // computation).
         cost_t before_cost =
-          _matrix[edge_1_start][edge_1_end] + _matrix[edge_2_start][edge_2_end];
+          _matrix(edge_1_start, edge_1_end) + _matrix(edge_2_start, edge_2_end);
         cost_t after_cost =
-          _matrix[edge_1_start][edge_2_start] + _matrix[edge_1_end][edge_2_end];
+          _matrix(edge_1_start, edge_2_start) + _matrix(edge_1_end, edge_2_end);
 
         // Updating the cost of the part of the tour that needs to be
         // reversed.
-        before_reversed_part_cost += _matrix[previous][edge_2_start];
-        after_reversed_part_cost += _matrix[edge_2_start][previous];
+        before_reversed_part_cost += _matrix(previous, edge_2_start);
+        after_reversed_part_cost += _matrix(edge_2_start, previous);
 
         // Adding to the costs for comparison.
         before_cost += before_reversed_part_cost;
@@ -542,47 +551,33 @@ cost_t local_search::asym_two_opt_step() {
     } while (edge_1_start != end);
   };
 
-  // Store best values per thread.
-  std::vector<cost_t> best_gains(_nb_threads, 0);
-  std::vector<index_t> best_edge_1_starts(_nb_threads);
-  std::vector<index_t> best_edge_2_starts(_nb_threads);
-  std::size_t thread_range = _edges.size() / _nb_threads;
+  // Store best values per range.
+  std::vector<cost_t> best_gains(_nb_ranges, 0);
+  std::vector<index_t> best_edge_1_starts(_nb_ranges);
+  std::vector<index_t> best_edge_2_starts(_nb_ranges);
+  std::size_t thread_range = _edges.size() / _nb_ranges;
 
-  // The limits in the range given to each thread are not ranks but
+  // The limits in the range given to each look-up are not ranks but
   // actual nodes used to browse a piece of the current tour.
   std::vector<std::size_t> limit_nodes{init};
   index_t node = init;
-  for (std::size_t i = 0; i < _nb_threads - 1; ++i) {
-    // Finding nodes that separate current tour in _nb_threads ranges.
+  for (std::size_t i = 0; i < _nb_ranges - 1; ++i) {
+    // Finding nodes that separate current tour in _nb_ranges ranges.
     for (std::size_t j = 0; j < thread_range; ++j, node = _edges.at(node)) {
     }
     limit_nodes.push_back(node);
   }
   limit_nodes.push_back(init);
 
-  // Start other threads, keeping a piece of the range for the main
-  // thread.
-  std::vector<std::thread> threads;
-  for (std::size_t i = 0; i < _nb_threads - 1; ++i) {
-    threads.emplace_back(look_up,
-                         limit_nodes[i],
-                         limit_nodes[i + 1],
-                         std::ref(best_gains[i]),
-                         std::ref(best_edge_1_starts[i]),
-                         std::ref(best_edge_2_starts[i]));
-  }
-
-  look_up(limit_nodes[_nb_threads - 1],
-          limit_nodes[_nb_threads],
-          std::ref(best_gains[_nb_threads - 1]),
-          std::ref(best_edge_1_starts[_nb_threads - 1]),
-          std::ref(best_edge_2_starts[_nb_threads - 1]));
-
-  for (auto& t : threads) {
-    t.join();
-  }
+  run_look_ups([&](std::size_t i) {
+    look_up(limit_nodes[i],
+            limit_nodes[i + 1],
+            best_gains[i],
+            best_edge_1_starts[i],
+            best_edge_2_starts[i]);
+  });
 
-  // Spot best gain found among all threads.
+  // Spot best gain found among all ranges.
   auto best_rank =
     std::distance(best_gains.begin(),
                   std::max_element(best_gains.begin(), best_gains.end()));
@@ -612,7 +607,8 @@ cost_t local_search::asym_two_opt_step() {
   return best_gain;
 }
 
-cost_t local_search::perform_all_two_opt_steps() {
+template <class Matrix>
+cost_t local_search<Matrix>::perform_all_two_opt_steps() {
   cost_t total_gain = 0;
   unsigned two_opt_iter = 0;
   cost_t gain = 0;
@@ -633,7 +629,8 @@ cost_t local_search::perform_all_two_opt_steps() {
   return total_gain;
 }
 
-cost_t local_search::perform_all_asym_two_opt_steps() {
+template <class Matrix>
+cost_t local_search<Matrix>::perform_all_asym_two_opt_steps() {
   cost_t total_gain = 0;
   unsigned two_opt_iter = 0;
   cost_t gain = 0;
@@ -654,7 +651,7 @@ cost_t local_search::perform_all_asym_two_opt_steps() {
   return total_gain;
 }
 
-cost_t local_search::or_opt_step() {
+template <class Matrix> cost_t local_search<Matrix>::or_opt_step() {
   if (_edges.size() < 4) {
     // Not enough edges for the operator to make sense.
     return 0;
@@ -681,17 +678,17 @@ cost_t local_search::or_opt_step() {
       // --> next --> edge_2_end.
 
       // Precomputing weights not depending on edge_2.
-      cost_t first_potential_add = _matrix[edge_1_start][next_2];
-      cost_t edge_1_weight = _matrix[edge_1_start][edge_1_end];
-      cost_t next_next_2_weight = _matrix[next][next_2];
+      cost_t first_potential_add = _matrix(edge_1_start, next_2);
+      cost_t edge_1_weight = _matrix(edge_1_start, edge_1_end);
+      cost_t next_next_2_weight = _matrix(next, next_2);
 
       while (edge_2_start != edge_1_start) {
         index_t edge_2_end = _edges.at(edge_2_start);
         cost_t before_cost = edge_1_weight + next_next_2_weight +
-                             _matrix[edge_2_start][edge_2_end];
+                             _matrix(edge_2_start, edge_2_end);
         cost_t after_cost = first_potential_add +
-                            _matrix[edge_2_start][edge_1_end] +
-                            _matrix[next][edge_2_end];
+                            _matrix(edge_2_start, edge_1_end) +
+                            _matrix(next, edge_2_end);
         if (before_cost > after_cost) {
           cost_t gain = before_cost - after_cost;
           if (gain > best_gain) {
@@ -706,34 +703,20 @@ cost_t local_search::or_opt_step() {
     }
   };
 
-  // Store best values per thread.
-  std::vector<cost_t> best_gains(_nb_threads, 0);
-  std::vector<index_t> best_edge_1_starts(_nb_threads);
-  std::vector<index_t> best_edge_2_starts(_nb_threads);
-
-  // Start other threads, keeping a piece of the range for the main
-  // thread.
-  std::vector<std::thread> threads;
-  for (std::size_t i = 0; i < _nb_threads - 1; ++i) {
-    threads.emplace_back(look_up,
-                         _rank_limits[i],
-                         _rank_limits[i + 1],
-                         std::ref(best_gains[i]),
-                         std::ref(best_edge_1_starts[i]),
-                         std::ref(best_edge_2_starts[i]));
-  }
-
-  look_up(_rank_limits[_nb_threads - 1],
-          _rank_limits[_nb_threads],
-          std::ref(best_gains[_nb_threads - 1]),
-          std::ref(best_edge_1_starts[_nb_threads - 1]),
-          std::ref(best_edge_2_starts[_nb_threads - 1]));
+  // Store best values per range.
+  std::vector<cost_t> best_gains(_nb_ranges, 0);
+  std::vector<index_t> best_edge_1_starts(_nb_ranges);
+  std::vector<index_t> best_edge_2_starts(_nb_ranges);
 
-  for (auto& t : threads) {
-    t.join();
-  }
+  run_look_ups([&](std::size_t i) {
+    look_up(_rank_limits[i],
+            _rank_limits[i + 1],
+            best_gains[i],
+            best_edge_1_starts[i],
+            best_edge_2_starts[i]);
+  });
 
-  // Spot best gain found among all threads.
+  // Spot best gain found among all ranges.
   auto best_rank =
     std::distance(best_gains.begin(),
                   std::max_element(best_gains.begin(), best_gains.end()));
@@ -753,7 +736,8 @@ cost_t local_search::or_opt_step() {
   return best_gain;
 }
 
-cost_t local_search::perform_all_or_opt_steps() {
+template <class Matrix>
+cost_t local_search<Matrix>::perform_all_or_opt_steps() {
   cost_t total_gain = 0;
   unsigned or_opt_iter = 0;
   cost_t gain = 0;
@@ -773,8 +757,10 @@ cost_t local_search::perform_all_or_opt_steps() {
   return total_gain;
 }
 
-std::list<index_t> local_search::get_tour(index_t first_index) const {
-  std::list<index_t> tour;
+template <class Matrix>
+tour_t local_search<Matrix>::get_tour(index_t first_index) const {
+  tour_t tour;
+  tour.reserve(_edges.size());
   tour.push_back(first_index);
   index_t next_index = _edges.at(first_index);
   while (next_index != first_index) {
@@ -783,3 +769,9 @@ std::list<index_t> local_search::get_tour(index_t first_index) const {
   }
   return tour;
 }
+
+template class local_search<matrix<cost_t>>;
+template class local_search<round_trip_cost>;
+template class local_search<start_only_cost>;
+template class local_search<end_only_cost>;
+template class local_search<start_and_end_cost>;
@@ -10,31 +10,50 @@ All rights reserved (see LICENSE).
 
 */
 
-#include <list>
 #include <numeric>
-#include <thread>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <boost/log/trivial.hpp>
 
 #include "../../../structures/abstract/matrix.h"
+#include "../../../structures/abstract/tour.h"
 #include "../../../structures/typedefs.h"
+#include "../../../utils/task_executor.h"
 
-class local_search {
+// Look-ups are split in at most one range per executor thread, with
+// at least this many ranks per range so that running a range as a
+// task is worth it.
+constexpr std::size_t MIN_LOOK_UP_RANGE = 64;
+
+// Local search operators, Matrix being either a plain matrix or a
+// cost policy providing size() and operator()(i, j).
+template <class Matrix> class local_search {
 private:
-  const matrix<cost_t>& _matrix;
+  const Matrix& _matrix;
   const bool _is_symmetric_matrix;
   std::vector<index_t> _edges;
-  unsigned _nb_threads;
+  task_executor& _executor;
+  std::size_t _nb_ranges;
   std::vector<index_t> _rank_limits;
   std::vector<index_t> _sym_two_opt_rank_limits;
 
+  // Buffers reused across avoid_loop_step calls.
+  std::vector<index_t> _tour_order;
+  std::vector<index_t> _previous;
+  std::vector<index_t> _possible_position;
+  std::vector<std::pair<index_t, index_t>> _relocatable_chains;
+  std::vector<index_t> _edges_copy;
+  std::vector<index_t> _previous_copy;
+
+  // Run look_up(i) for all ranges i, concurrently on _executor.
+  template <class Function> void run_look_ups(Function look_up);
+
 public:
-  local_search(const matrix<cost_t>& matrix,
+  local_search(const Matrix& matrix,
                bool is_symmetric_matrix,
-               const std::list<index_t>& tour,
-               unsigned nb_threads);
+               const tour_t& tour,
+               task_executor& executor);
 
   cost_t relocate_step();
 
@@ -56,7 +75,7 @@ public:
 
   cost_t perform_all_or_opt_steps();
 
-  std::list<index_t> get_tour(index_t first_index) const;
+  tour_t get_tour(index_t first_index) const;
 };
 
 #endif
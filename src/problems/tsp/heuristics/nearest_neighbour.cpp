@@ -0,0 +1,58 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <limits>
+
+#include "nearest_neighbour.h"
+#include "../../../structures/abstract/matrix.h"
+
+template <class Matrix>
+tour_t nearest_neighbour(const Matrix& m,
+                         const std::vector<std::vector<index_t>>& candidates,
+                         index_t start) {
+  const index_t n = m.size();
+  std::vector<bool> visited(n, false);
+
+  tour_t tour;
+  tour.reserve(n);
+  tour.push_back(start);
+  visited[start] = true;
+
+  index_t current = start;
+  for (index_t step = 1; step < n; ++step) {
+    index_t next = current;
+    for (const auto j : candidates[current]) {
+      if (!visited[j]) {
+        next = j;
+        break;
+      }
+    }
+
+    if (next == current) {
+      cost_t next_cost = std::numeric_limits<cost_t>::max();
+      for (index_t j = 0; j < n; ++j) {
+        if (!visited[j] and (next == current or m(current, j) < next_cost)) {
+          next_cost = m(current, j);
+          next = j;
+        }
+      }
+    }
+
+    tour.push_back(next);
+    visited[next] = true;
+    current = next;
+  }
+
+  return tour;
+}
+
+template tour_t
+nearest_neighbour(const matrix<cost_t>& m,
+                  const std::vector<std::vector<index_t>>& candidates,
+                  index_t start);
@@ -0,0 +1,25 @@
+#ifndef NEAREST_NEIGHBOUR_H
+#define NEAREST_NEIGHBOUR_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <vector>
+
+#include "../../../structures/abstract/tour.h"
+
+// Nearest neighbour heuristic from start. Candidates being sorted,
+// the first unvisited one is the nearest unvisited node so a full
+// scan is only required when all candidates are already visited.
+template <class Matrix>
+tour_t nearest_neighbour(const Matrix& m,
+                         const std::vector<std::vector<index_t>>& candidates,
+                         index_t start);
+
+#endif
@@ -0,0 +1,75 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "space_filling_curve.h"
+
+// Number of cells on each side of the grid used to compute Hilbert
+// curve positions.
+constexpr uint32_t HILBERT_GRID_SIZE = 1 << 16;
+
+// Position of cell (x, y) along the Hilbert curve filling the grid.
+uint64_t hilbert_position(uint32_t x, uint32_t y) {
+  uint64_t position = 0;
+  for (uint32_t s = HILBERT_GRID_SIZE / 2; s > 0; s /= 2) {
+    const uint32_t rx = (x & s) ? 1 : 0;
+    const uint32_t ry = (y & s) ? 1 : 0;
+    position += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+
+    // Rotate quadrant.
+    if (ry == 0) {
+      if (rx == 1) {
+        x = HILBERT_GRID_SIZE - 1 - x;
+        y = HILBERT_GRID_SIZE - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return position;
+}
+
+tour_t space_filling_curve(const std::vector<coords_t>& coordinates) {
+  tour_t tour;
+  if (coordinates.empty()) {
+    return tour;
+  }
+
+  coords_t min_coords = coordinates.front();
+  coords_t max_coords = coordinates.front();
+  for (const auto& c : coordinates) {
+    for (std::size_t d = 0; d < 2; ++d) {
+      min_coords[d] = std::min(min_coords[d], c[d]);
+      max_coords[d] = std::max(max_coords[d], c[d]);
+    }
+  }
+
+  // Scale both dimensions the same way to preserve proximity.
+  const coordinate_t extent = std::max(max_coords[0] - min_coords[0],
+                                       max_coords[1] - min_coords[1]);
+  const coordinate_t scale =
+    (extent > 0) ? (HILBERT_GRID_SIZE - 1) / extent : 0;
+
+  std::vector<std::pair<uint64_t, index_t>> positions;
+  positions.reserve(coordinates.size());
+  for (index_t i = 0; i < coordinates.size(); ++i) {
+    uint32_t x = (coordinates[i][0] - min_coords[0]) * scale;
+    uint32_t y = (coordinates[i][1] - min_coords[1]) * scale;
+    positions.emplace_back(hilbert_position(x, y), i);
+  }
+  std::sort(positions.begin(), positions.end());
+
+  tour.reserve(coordinates.size());
+  for (const auto& p : positions) {
+    tour.push_back(p.second);
+  }
+  return tour;
+}
@@ -0,0 +1,23 @@
+#ifndef SPACE_FILLING_CURVE_H
+#define SPACE_FILLING_CURVE_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <array>
+#include <vector>
+
+#include "../../../structures/abstract/tour.h"
+
+// Visit nodes in the order of their position along a Hilbert curve
+// covering the bounding box of coordinates. Runs in O(n log n) and
+// does not use costs at all.
+tour_t space_filling_curve(const std::vector<coords_t>& coordinates);
+
+#endif
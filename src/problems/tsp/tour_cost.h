@@ -0,0 +1,83 @@
+#ifndef TOUR_COST_H
+#define TOUR_COST_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include "../../structures/abstract/matrix_view.h"
+#include "../../structures/typedefs.h"
+
+// Tour types with regard to vehicle start and end.
+enum class TOUR_T { ROUND_TRIP, START_ONLY, END_ONLY, START_AND_END };
+
+// Cost policy applying the rules for a tour type on top of the costs
+// provided by a view. Open tours are encoded by altering costs to and
+// from start and end, which used to require a modified copy of the
+// matrix. The tour type being a template parameter, the switch below
+// is resolved at compile time.
+template <class View, TOUR_T tour_type> class tour_cost {
+private:
+  const View& _view;
+  const index_t _start;
+  const index_t _end;
+
+public:
+  tour_cost(const View& view, index_t start, index_t end)
+    : _view(view), _start(start), _end(end) {
+  }
+
+  std::size_t size() const {
+    return _view.size();
+  }
+
+  cost_t operator()(index_t i, index_t j) const {
+    if (i == j) {
+      // Distances on the diagonal are never used except in the
+      // minimum weight perfect matching. This makes sure no node
+      // will be matched with itself at that time.
+      return INFINITE_COST;
+    }
+    switch (tour_type) {
+    case TOUR_T::ROUND_TRIP:
+      break;
+    case TOUR_T::START_ONLY:
+      // Forcing first location as start, end location decided during
+      // optimization.
+      if (j == _start) {
+        return 0;
+      }
+      break;
+    case TOUR_T::END_ONLY:
+      // Forcing last location as end, start location decided during
+      // optimization.
+      if (i == _end) {
+        return 0;
+      }
+      break;
+    case TOUR_T::START_AND_END:
+      // Forcing first location as start, last location as end to
+      // produce an open tour.
+      if (i == _end) {
+        return (j == _start) ? 0 : INFINITE_COST;
+      }
+      break;
+    }
+    return _view(i, j);
+  }
+};
+
+// Policies used for TSP sub-problems, on top of a view on the input
+// matrix.
+using round_trip_cost = tour_cost<matrix_view<cost_t>, TOUR_T::ROUND_TRIP>;
+using start_only_cost = tour_cost<matrix_view<cost_t>, TOUR_T::START_ONLY>;
+using end_only_cost = tour_cost<matrix_view<cost_t>, TOUR_T::END_ONLY>;
+using start_and_end_cost =
+  tour_cost<matrix_view<cost_t>, TOUR_T::START_AND_END>;
+
+#endif
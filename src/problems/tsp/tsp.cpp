@@ -10,6 +10,22 @@ All rights reserved (see LICENSE).
 #include "tsp.h"
 #include "../../structures/vroom/input/input.h"
 
+template <class Function> auto tsp::with_cost_policy(Function f) const {
+  matrix_view<cost_t> view(_input.get_matrix(), _matrix_ranks);
+
+  switch (_tour_type) {
+  case TOUR_T::START_ONLY:
+    return f(start_only_cost(view, _start, _end));
+  case TOUR_T::END_ONLY:
+    return f(end_only_cost(view, _start, _end));
+  case TOUR_T::START_AND_END:
+    return f(start_and_end_cost(view, _start, _end));
+  default:
+    assert(_tour_type == TOUR_T::ROUND_TRIP);
+    return f(round_trip_cost(view, _start, _end));
+  }
+}
+
 tsp::tsp(const input& input,
          std::vector<index_t> job_ranks,
          index_t vehicle_rank)
@@ -17,190 +33,363 @@ tsp::tsp(const input& input,
     _vehicle_rank(vehicle_rank),
     _job_ranks(std::move(job_ranks)),
     _is_symmetric(true),
+    _asymmetry(0),
     _has_start(_input._vehicles[_vehicle_rank].has_start()),
-    _has_end(_input._vehicles[_vehicle_rank].has_end()) {
+    _start(0),
+    _has_end(_input._vehicles[_vehicle_rank].has_end()),
+    _end(0) {
 
   // Pick ranks to select from input matrix.
-  std::vector<index_t> matrix_ranks;
   std::transform(_job_ranks.cbegin(),
                  _job_ranks.cend(),
-                 std::back_inserter(matrix_ranks),
+                 std::back_inserter(_matrix_ranks),
                  [&](const auto& r) { return _input._jobs[r].index(); });
 
   if (_has_start) {
-    // Add start and remember rank in _matrix.
-    _start = matrix_ranks.size();
-    matrix_ranks.push_back(_input._vehicles[_vehicle_rank].start.get().index());
+    // Add start and remember its TSP index.
+    _start = _matrix_ranks.size();
+    _matrix_ranks.push_back(
+      _input._vehicles[_vehicle_rank].start.get().index());
   }
   if (_has_end) {
-    // Add end and remember rank in _matrix.
+    // Add end and remember its TSP index.
     if (_has_start and (_input._vehicles[_vehicle_rank].start.get().index() ==
                         _input._vehicles[_vehicle_rank].end.get().index())) {
       // Avoiding duplicate for identical ranks.
       _end = _start;
     } else {
-      _end = matrix_ranks.size();
-      matrix_ranks.push_back(_input._vehicles[_vehicle_rank].end.get().index());
+      _end = _matrix_ranks.size();
+      _matrix_ranks.push_back(
+        _input._vehicles[_vehicle_rank].end.get().index());
     }
   }
 
-  _matrix = _input.get_sub_matrix(matrix_ranks);
+  _round_trip = _has_start and _has_end and (_start == _end);
 
-  // Distances on the diagonal are never used except in the minimum
-  // weight perfect matching (munkres call during the heuristic). This
-  // makes sure no node will be matched with itself at that time.
-  for (index_t i = 0; i < _matrix.size(); ++i) {
-    _matrix[i][i] = INFINITE_COST;
+  if (_round_trip) {
+    _tour_type = TOUR_T::ROUND_TRIP;
+  } else if (_has_start and !_has_end) {
+    // Forcing first location as start, end location decided during
+    // optimization.
+    _tour_type = TOUR_T::START_ONLY;
+  } else if (!_has_start and _has_end) {
+    // Forcing last location as end, start location decided during
+    // optimization.
+    _tour_type = TOUR_T::END_ONLY;
+  } else {
+    // Forcing first location as start, last location as end to
+    // produce an open tour.
+    assert(_start != _end);
+    _tour_type = TOUR_T::START_AND_END;
   }
 
-  _round_trip = _has_start and _has_end and (_start == _end);
+  with_cost_policy([&](const auto& m) {
+    this->symmetrize(m);
+    return 0;
+  });
+}
 
-  if (!_round_trip) {
-    // Dealing with open tour cases. Exactly one of the following
-    // happens.
-    if (_has_start and !_has_end) {
-      // Forcing first location as start, end location decided during
-      // optimization.
-      for (index_t i = 0; i < _matrix.size(); ++i) {
-        if (i != _start) {
-          _matrix[i][_start] = 0;
+template <class Matrix> void tsp::symmetrize(const Matrix& m) {
+  // Using symmetrization with max when only start or only end is
+  // forced, as the cost policy then has a line or a column filled
+  // with zeros.
+  const bool use_max =
+    (_tour_type == TOUR_T::START_ONLY) or (_tour_type == TOUR_T::END_ONLY);
+
+  const index_t n = m.size();
+  const index_t nb_jobs = _job_ranks.size();
+  _symmetrized_matrix = matrix<cost_t>(n);
+
+  // Asymmetry is measured on the cheapest way out of each job, as
+  // this is what tours are made of. Start and end are left aside as
+  // their costs are altered by the cost policy for open tours.
+  std::vector<index_t> nearest(nb_jobs);
+  std::vector<cost_t> nearest_cost(nb_jobs,
+                                   std::numeric_limits<cost_t>::max());
+
+  // Costs are read one tile at a time for both directions, so that
+  // reading m(j, i) does not stride across the whole matrix. Min/max
+  // and comparisons then run on contiguous buffers and are
+  // vectorized by the compiler.
+  constexpr index_t T = SYMMETRIZATION_TILE_SIZE;
+  cost_t forward[T][T];
+  cost_t backward[T][T];
+  cost_t sym[T][T];
+  bool is_symmetric = true;
+
+  for (index_t bi = 0; bi < n; bi += T) {
+    const index_t i_size = std::min<index_t>(T, n - bi);
+
+    for (index_t bj = bi; bj < n; bj += T) {
+      const index_t j_size = std::min<index_t>(T, n - bj);
+
+      for (index_t i = 0; i < i_size; ++i) {
+        for (index_t j = 0; j < j_size; ++j) {
+          forward[i][j] = m(bi + i, bj + j);
         }
       }
-    }
-    if (!_has_start and _has_end) {
-      // Forcing last location as end, start location decided during
-      // optimization.
-      for (index_t j = 0; j < _matrix.size(); ++j) {
-        if (j != _end) {
-          _matrix[_end][j] = 0;
+      for (index_t j = 0; j < j_size; ++j) {
+        for (index_t i = 0; i < i_size; ++i) {
+          backward[i][j] = m(bj + j, bi + i);
         }
       }
-    }
-    if (_has_start and _has_end) {
-      // Forcing first location as start, last location as end to
-      // produce an open tour.
-      assert(_start != _end);
-      _matrix[_end][_start] = 0;
-      for (index_t j = 0; j < _matrix.size(); ++j) {
-        if ((j != _start) and (j != _end)) {
-          _matrix[_end][j] = INFINITE_COST;
+
+      bool tile_mismatch = false;
+      for (index_t i = 0; i < i_size; ++i) {
+        if (use_max) {
+          for (index_t j = 0; j < j_size; ++j) {
+            sym[i][j] = std::max(forward[i][j], backward[i][j]);
+          }
+        } else {
+          for (index_t j = 0; j < j_size; ++j) {
+            sym[i][j] = std::min(forward[i][j], backward[i][j]);
+          }
+        }
+        for (index_t j = 0; j < j_size; ++j) {
+          tile_mismatch |= (forward[i][j] != backward[i][j]);
+        }
+      }
+      is_symmetric &= !tile_mismatch;
+
+      for (index_t i = 0; i < i_size; ++i) {
+        auto& row = _symmetrized_matrix[bi + i];
+        for (index_t j = 0; j < j_size; ++j) {
+          row[bj + j] = sym[i][j];
+        }
+      }
+      if (bi != bj) {
+        for (index_t j = 0; j < j_size; ++j) {
+          auto& row = _symmetrized_matrix[bj + j];
+          for (index_t i = 0; i < i_size; ++i) {
+            row[bi + i] = sym[i][j];
+          }
+        }
+      }
+
+      // Candidates for a given job are met in increasing rank order
+      // across tiles, so ties are broken as with a plain row scan.
+      const index_t i_jobs =
+        (bi < nb_jobs) ? std::min<index_t>(i_size, nb_jobs - bi) : 0;
+      const index_t j_jobs =
+        (bj < nb_jobs) ? std::min<index_t>(j_size, nb_jobs - bj) : 0;
+      for (index_t i = 0; i < i_jobs; ++i) {
+        for (index_t j = 0; j < j_jobs; ++j) {
+          if (bi + i != bj + j and forward[i][j] < nearest_cost[bi + i]) {
+            nearest_cost[bi + i] = forward[i][j];
+            nearest[bi + i] = bj + j;
+          }
+        }
+      }
+      if (bi != bj) {
+        for (index_t j = 0; j < j_jobs; ++j) {
+          for (index_t i = 0; i < i_jobs; ++i) {
+            if (backward[i][j] < nearest_cost[bj + j]) {
+              nearest_cost[bj + j] = backward[i][j];
+              nearest[bj + j] = bi + i;
+            }
+          }
         }
       }
     }
   }
+  _is_symmetric = is_symmetric;
+
+  if (!_is_symmetric and nb_jobs > 1) {
+    double total_asymmetry = 0;
+    for (index_t i = 0; i < nb_jobs; ++i) {
+      double way_out = m(i, nearest[i]);
+      double way_back = m(nearest[i], i);
+      if (way_out + way_back > 0) {
+        total_asymmetry += (way_back - way_out) / (way_out + way_back);
+      }
+    }
+    _asymmetry = total_asymmetry / nb_jobs;
+  }
+}
 
-  // Compute symmetrized matrix and update _is_symmetric flag.
-  _symmetrized_matrix = matrix<cost_t>(_matrix.size());
-
-  const cost_t& (*sym_f)(const cost_t&, const cost_t&) = std::min<cost_t>;
-  if ((_has_start and !_has_end) or (!_has_start and _has_end)) {
-    // Using symmetrization with max as when only start or only end is
-    // forced, the matrix has a line or a column filled with zeros.
-    sym_f = std::max<cost_t>;
+bool tsp::get_coordinates(std::vector<coords_t>& coordinates) const {
+  std::vector<const location_t*> locations;
+  for (const auto r : _job_ranks) {
+    locations.push_back(&_input._jobs[r]);
+  }
+  if (_has_start) {
+    locations.push_back(&_input._vehicles[_vehicle_rank].start.get());
+  }
+  if (_has_end and !_round_trip) {
+    locations.push_back(&_input._vehicles[_vehicle_rank].end.get());
   }
-  for (index_t i = 0; i < _matrix.size(); ++i) {
-    _symmetrized_matrix[i][i] = _matrix[i][i];
-    for (index_t j = i + 1; j < _matrix.size(); ++j) {
-      _is_symmetric &= (_matrix[i][j] == _matrix[j][i]);
-      cost_t val = sym_f(_matrix[i][j], _matrix[j][i]);
-      _symmetrized_matrix[i][j] = val;
-      _symmetrized_matrix[j][i] = val;
+  assert(locations.size() == _matrix_ranks.size());
+
+  coordinates.clear();
+  for (const auto l : locations) {
+    if (!l->has_coordinates()) {
+      return false;
     }
+    coordinates.push_back({{l->lon(), l->lat()}});
   }
+  return true;
 }
 
-cost_t tsp::cost(const std::list<index_t>& tour) const {
-  cost_t cost = 0;
-  index_t init_step = 0; // Initialization actually never used.
+cost_t tsp::lower_bound(cost_t upper_bound, unsigned nb_iterations) const {
+  if (_tour_type == TOUR_T::ROUND_TRIP or
+      _tour_type == TOUR_T::START_AND_END) {
+    // Already symmetrized with min.
+    return one_tree_lower_bound(_symmetrized_matrix,
+                                upper_bound,
+                                nb_iterations);
+  }
 
-  auto step = tour.cbegin();
-  if (tour.size() > 0) {
-    init_step = *step;
+  return with_cost_policy([&](const auto& m) {
+    using policy = std::decay_t<decltype(m)>;
+    return one_tree_lower_bound(min_view<policy>(m),
+                                upper_bound,
+                                nb_iterations);
+  });
+}
+
+cost_t tsp::cost(const tour_t& tour) const {
+  return with_cost_policy([&](const auto& m) { return tour.cost(m); });
+}
+
+cost_t tsp::symmetrized_cost(const tour_t& tour) const {
+  return tour.cost(_symmetrized_matrix);
+}
+
+solution tsp::solve(unsigned nb_threads) const {
+  task_executor executor(nb_threads);
+  return solve(executor, nb_threads);
+}
+
+tsp_key tsp::cache_key(std::vector<index_t>& key_ranks) const {
+  const index_t nb_jobs = _job_ranks.size();
+  key_ranks.resize(nb_jobs);
+  std::iota(key_ranks.begin(), key_ranks.end(), 0);
+  std::stable_sort(key_ranks.begin(),
+                   key_ranks.end(),
+                   [&](auto lhs, auto rhs) {
+                     return _matrix_ranks[lhs] < _matrix_ranks[rhs];
+                   });
+
+  // Start and end keep their TSP indices after jobs.
+  std::vector<index_t> order(key_ranks);
+  for (index_t i = nb_jobs; i < _matrix_ranks.size(); ++i) {
+    order.push_back(i);
   }
 
-  index_t previous_step = init_step;
-  ++step;
-  for (; step != tour.cend(); ++step) {
-    cost += _matrix[previous_step][*step];
-    previous_step = *step;
+  std::vector<index_t> indices;
+  indices.reserve(order.size());
+  for (auto i : order) {
+    indices.push_back(_matrix_ranks[i]);
   }
-  if (tour.size() > 0) {
-    cost += _matrix[previous_step][init_step];
+
+  // FNV-1a over costs in key order.
+  const auto& m = _input.get_matrix();
+  uint64_t costs_hash = 14695981039346656037ull;
+  for (auto i : indices) {
+    for (auto j : indices) {
+      costs_hash = (costs_hash ^ m[i][j]) * 1099511628211ull;
+    }
   }
-  return cost;
+
+  return tsp_key(_tour_type,
+                 std::move(indices),
+                 costs_hash,
+                 _input.get_construction(),
+                 _input.get_gap_threshold());
 }
 
-cost_t tsp::symmetrized_cost(const std::list<index_t>& tour) const {
-  cost_t cost = 0;
-  index_t init_step = 0; // Initialization actually never used.
+solution tsp::solve(task_executor& executor, unsigned nb_threads) const {
+  // Identical TSP, e.g. from several clusterings or repeated
+  // requests, are only solved once. Cached tours use key order for
+  // jobs.
+  std::vector<index_t> key_ranks;
+  auto key = cache_key(key_ranks);
+  const index_t nb_jobs = _job_ranks.size();
+
+  tsp_result result;
+  if (tsp_cache::shared().find(key, result)) {
+    BOOST_LOG_TRIVIAL(info) << "[TSP] Using cached solution.";
+    for (std::size_t i = 0; i < result.tour.size(); ++i) {
+      if (result.tour[i] < nb_jobs) {
+        result.tour[i] = key_ranks[result.tour[i]];
+      }
+    }
+  } else {
+    result = with_cost_policy([&](const auto& m) {
+      return this->solve_tour(m, executor, nb_threads);
+    });
 
-  auto step = tour.cbegin();
-  if (tour.size() > 0) {
-    init_step = *step;
+    std::vector<index_t> key_positions(nb_jobs);
+    for (index_t p = 0; p < nb_jobs; ++p) {
+      key_positions[key_ranks[p]] = p;
+    }
+    tsp_result cached = result;
+    for (std::size_t i = 0; i < cached.tour.size(); ++i) {
+      if (cached.tour[i] < nb_jobs) {
+        cached.tour[i] = key_positions[cached.tour[i]];
+      }
+    }
+    tsp_cache::shared().insert(std::move(key), std::move(cached));
   }
 
-  index_t previous_step = init_step;
-  ++step;
-  for (; step != tour.cend(); ++step) {
-    cost += _symmetrized_matrix[previous_step][*step];
-    previous_step = *step;
+  tour_t& current_sol = result.tour;
+  cost_t current_cost = result.cost;
+
+  // Deal with open tour cases requiring adaptation.
+  if (!_has_start and _has_end) {
+    // The tour has been listed starting with the "forced" end. This
+    // index has to be put back, the next element being the chosen
+    // start resulting from the optimization.
+    current_sol.rotate_to(current_sol[1]);
   }
-  if (tour.size() > 0) {
-    cost += _symmetrized_matrix[previous_step][init_step];
+
+  // Steps for the one route.
+  std::vector<step> steps;
+
+  // Handle start.
+  auto job_start = current_sol.cbegin();
+  if (_has_start) {
+    // Add start step.
+    assert(current_sol.front() == _start);
+    steps.emplace_back(TYPE::START,
+                       _input._vehicles[_vehicle_rank].start.get());
+    // Remember that jobs start further away in the list.
+    ++job_start;
   }
-  return cost;
-}
+  // Determine where to stop for last job.
+  auto job_end = current_sol.cend();
 
-solution tsp::solve(unsigned nb_threads) const {
-  // Applying heuristic.
-  auto start_heuristic = std::chrono::high_resolution_clock::now();
-  BOOST_LOG_TRIVIAL(info) << "[TSP] Start heuristic on symmetrized problem.";
-
-  std::list<index_t> christo_sol = christofides(_symmetrized_matrix);
-  cost_t christo_cost = this->symmetrized_cost(christo_sol);
-
-  auto end_heuristic = std::chrono::high_resolution_clock::now();
-
-  auto heuristic_computing_time =
-    std::chrono::duration_cast<std::chrono::milliseconds>(end_heuristic -
-                                                          start_heuristic)
-      .count();
-
-  BOOST_LOG_TRIVIAL(info) << "[TSP] Done in " << heuristic_computing_time
-                          << " ms, symmetric solution cost is " << christo_cost
-                          << ".";
-
-  // Local search on symmetric problem.
-  // Applying deterministic, fast local search to improve the current
-  // solution in a small amount of time. All possible moves for the
-  // different neighbourhoods are performed, stopping when reaching a
-  // local minima.
-  auto start_sym_local_search = std::chrono::high_resolution_clock::now();
-  BOOST_LOG_TRIVIAL(info)
-    << "[TSP] Start local search on symmetrized problem using " << nb_threads
-    << " thread(s).";
-
-  local_search sym_ls(_symmetrized_matrix,
-                      true, // Symmetrized problem.
-                      christo_sol,
-                      nb_threads);
-
-  cost_t sym_two_opt_gain = 0;
-  cost_t sym_relocate_gain = 0;
-  cost_t sym_or_opt_gain = 0;
-
-  do {
-    // All possible 2-opt moves.
-    sym_two_opt_gain = sym_ls.perform_all_two_opt_steps();
-
-    // All relocate moves.
-    sym_relocate_gain = sym_ls.perform_all_relocate_steps();
-
-    // All or-opt moves.
-    sym_or_opt_gain = sym_ls.perform_all_or_opt_steps();
-  } while ((sym_two_opt_gain > 0) or (sym_relocate_gain > 0) or
-           (sym_or_opt_gain > 0));
+  if (!_round_trip and _has_end) {
+    --job_end;
+  }
 
+  // Handle jobs.
+  for (auto job = job_start; job != job_end; ++job) {
+    auto current_rank = _job_ranks[*job];
+    steps.emplace_back(TYPE::JOB,
+                       _input._jobs[current_rank],
+                       _input._jobs[current_rank].id);
+  }
+  // Handle end.
+  if (_has_end) {
+    // Add end step.
+    steps.emplace_back(TYPE::END, _input._vehicles[_vehicle_rank].end.get());
+  }
+
+  // Route.
+  std::vector<route_t> routes;
+  routes.emplace_back(_input._vehicles[_vehicle_rank].id, steps, current_cost);
+  routes.back().lower_bound = result.lower_bound;
+
+  solution sol(0, current_cost, std::move(routes), std::vector<job_t>());
+
+  return sol;
+}
+
+template <class Matrix>
+tsp_result tsp::solve_tour(const Matrix& m,
+                           task_executor& executor,
+                           unsigned nb_threads) const {
   index_t first_loc_index;
   if (_has_start) {
     // Use start value set in constructor from vehicle input.
@@ -212,57 +401,270 @@ solution tsp::solve(unsigned nb_threads) const {
     first_loc_index = _end;
   }
 
-  std::list<index_t> current_sol = sym_ls.get_tour(first_loc_index);
-  auto current_cost = this->symmetrized_cost(current_sol);
+  // Node-based containers used during construction draw from this
+  // arena, released at once when done solving.
+  arena memory;
+
+  tour_t current_sol;
+  cost_t current_cost;
+  cost_t bound = 0;
+
+  auto compute_bound = [&](cost_t upper_bound, unsigned nb_iterations) {
+    auto start_bound = std::chrono::high_resolution_clock::now();
+
+    bound = this->lower_bound(upper_bound, nb_iterations);
+
+    auto end_bound = std::chrono::high_resolution_clock::now();
+
+    auto bound_computing_time =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end_bound -
+                                                            start_bound)
+        .count();
+
+    BOOST_LOG_TRIVIAL(info) << "[TSP] Lower bound is " << bound
+                            << ", computed in " << bound_computing_time
+                            << " ms.";
+  };
+
+  // Local search phases stop as soon as the relative gap between
+  // cost and lower bound is small enough. Without threshold, the
+  // bound is only reported and is computed once done with local
+  // search, so that it does not delay it.
+  const double gap_threshold = _input.get_gap_threshold();
+  const bool early_bound = gap_threshold > 0;
+  auto gap_reached = [&](cost_t cost) {
+    if (cost <= bound * (1 + gap_threshold)) {
+      BOOST_LOG_TRIVIAL(info) << "[TSP] Gap threshold reached.";
+      return true;
+    }
+    return false;
+  };
+
+  CONSTRUCTION_T construction = _input.get_construction();
+  if (construction == CONSTRUCTION_T::HELD_KARP and
+      _matrix_ranks.size() > HELD_KARP_MAX_SIZE) {
+    BOOST_LOG_TRIVIAL(info) << "[TSP] Too many locations for Held-Karp, "
+                               "using automatic construction.";
+    construction = CONSTRUCTION_T::AUTO;
+  }
+  if (construction == CONSTRUCTION_T::AUTO) {
+    if (_matrix_ranks.size() <= HELD_KARP_THRESHOLD) {
+      construction = CONSTRUCTION_T::HELD_KARP;
+    } else if (_matrix_ranks.size() >= FAST_CONSTRUCTION_THRESHOLD) {
+      construction = CONSTRUCTION_T::GREEDY;
+    } else if (_asymmetry > ASYMMETRIC_CONSTRUCTION_THRESHOLD) {
+      construction = CONSTRUCTION_T::ASSIGNMENT_PATCHING;
+    } else if (_matrix_ranks.size() >= SPARSE_CONSTRUCTION_THRESHOLD) {
+      construction = CONSTRUCTION_T::SPARSE_CHRISTOFIDES;
+    } else {
+      construction = CONSTRUCTION_T::CHRISTOFIDES;
+    }
+  }
+
+  std::vector<coords_t> coordinates;
+  if (construction == CONSTRUCTION_T::SPACE_FILLING_CURVE and
+      !this->get_coordinates(coordinates)) {
+    BOOST_LOG_TRIVIAL(info) << "[TSP] Missing coordinates for space-filling "
+                               "curve, using greedy heuristic.";
+    construction = CONSTRUCTION_T::GREEDY;
+  }
+
+  if (construction == CONSTRUCTION_T::HELD_KARP) {
+    // Small problem: solving to optimality directly on the actual
+    // costs, so there is no need for any local search.
+    auto start_exact = std::chrono::high_resolution_clock::now();
+    BOOST_LOG_TRIVIAL(info) << "[TSP] Start exact resolution.";
+
+    current_sol = held_karp(m, first_loc_index);
+    current_cost = current_sol.cost(m);
+    bound = current_cost;
+
+    auto end_exact = std::chrono::high_resolution_clock::now();
+
+    auto exact_computing_time =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end_exact -
+                                                            start_exact)
+        .count();
+
+    BOOST_LOG_TRIVIAL(info) << "[TSP] Done in " << exact_computing_time
+                            << " ms, optimal solution cost is "
+                            << current_cost << ".";
+  } else if (construction == CONSTRUCTION_T::ASSIGNMENT_PATCHING) {
+    // Strongly asymmetric problem: symmetrizing would discard most of
+    // the cost structure so the symmetric phase is skipped.
+    auto start_heuristic = std::chrono::high_resolution_clock::now();
+    BOOST_LOG_TRIVIAL(info)
+      << "[TSP] Start heuristic on asymmetric problem (asymmetry: "
+      << std::fixed << std::setprecision(2) << _asymmetry << ").";
+
+    current_sol = assignment_patching(m, memory);
+    current_sol.rotate_to(first_loc_index);
+    current_cost = current_sol.cost(m);
+
+    auto end_heuristic = std::chrono::high_resolution_clock::now();
+
+    auto heuristic_computing_time =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end_heuristic -
+                                                            start_heuristic)
+        .count();
+
+    BOOST_LOG_TRIVIAL(info) << "[TSP] Done in " << heuristic_computing_time
+                            << " ms, asymmetric solution cost is "
+                            << current_cost << ".";
+
+    if (early_bound) {
+      compute_bound(current_cost, LOWER_BOUND_ITERATIONS);
+    }
+  } else {
+    // Applying heuristic.
+    auto start_heuristic = std::chrono::high_resolution_clock::now();
+    BOOST_LOG_TRIVIAL(info) << "[TSP] Start heuristic on symmetrized problem.";
+
+    tour_t heuristic_sol;
+    switch (construction) {
+    case CONSTRUCTION_T::SPACE_FILLING_CURVE:
+      heuristic_sol = space_filling_curve(coordinates);
+      break;
+    case CONSTRUCTION_T::SPARSE_CHRISTOFIDES:
+      heuristic_sol =
+        sparse_christofides(_symmetrized_matrix,
+                            nearest_candidates(_symmetrized_matrix,
+                                               NB_CANDIDATES),
+                            nb_threads,
+                            MATCHING_T::AUTO,
+                            memory);
+      break;
+    case CONSTRUCTION_T::GREEDY:
+      heuristic_sol =
+        greedy_edge(_symmetrized_matrix,
+                    nearest_candidates(_symmetrized_matrix, NB_CANDIDATES));
+      break;
+    case CONSTRUCTION_T::NEAREST_NEIGHBOUR:
+      heuristic_sol =
+        nearest_neighbour(_symmetrized_matrix,
+                          nearest_candidates(_symmetrized_matrix,
+                                             NB_CANDIDATES),
+                          first_loc_index);
+      break;
+    default:
+      assert(construction == CONSTRUCTION_T::CHRISTOFIDES);
+      heuristic_sol =
+        christofides(_symmetrized_matrix,
+                     nb_threads,
+                     MATCHING_T::AUTO,
+                     memory);
+    }
+    cost_t heuristic_cost = this->symmetrized_cost(heuristic_sol);
+
+    auto end_heuristic = std::chrono::high_resolution_clock::now();
+
+    auto heuristic_computing_time =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end_heuristic -
+                                                            start_heuristic)
+        .count();
 
-  auto end_sym_local_search = std::chrono::high_resolution_clock::now();
+    BOOST_LOG_TRIVIAL(info) << "[TSP] Done in " << heuristic_computing_time
+                            << " ms, symmetric solution cost is "
+                            << heuristic_cost << ".";
 
-  auto sym_local_search_duration =
-    std::chrono::duration_cast<std::chrono::milliseconds>(
-      end_sym_local_search - start_sym_local_search)
-      .count();
-  BOOST_LOG_TRIVIAL(info) << "[TSP] Done in " << sym_local_search_duration
-                          << " ms, symmetric solution cost is now "
-                          << current_cost << " (" << std::fixed
-                          << std::setprecision(2)
-                          << 100 * (((double)current_cost) / christo_cost - 1)
-                          << "%).";
+    if (early_bound) {
+      compute_bound(heuristic_cost, LOWER_BOUND_ITERATIONS);
+    }
+
+    // Local search on symmetric problem.
+    // Applying deterministic, fast local search to improve the
+    // current solution in a small amount of time. All possible moves
+    // for the different neighbourhoods are performed, stopping when
+    // reaching a local minima.
+    auto start_sym_local_search = std::chrono::high_resolution_clock::now();
+    BOOST_LOG_TRIVIAL(info)
+      << "[TSP] Start local search on symmetrized problem using "
+      << executor.size() << " thread(s).";
+
+    local_search<matrix<cost_t>> sym_ls(_symmetrized_matrix,
+                                         true, // Symmetrized problem.
+                                         heuristic_sol,
+                                         executor);
+
+    cost_t sym_two_opt_gain = 0;
+    cost_t sym_relocate_gain = 0;
+    cost_t sym_or_opt_gain = 0;
+    cost_t sym_cost = heuristic_cost;
+
+    do {
+      if (gap_reached(sym_cost)) {
+        break;
+      }
+
+      // All possible 2-opt moves.
+      sym_two_opt_gain = sym_ls.perform_all_two_opt_steps();
+
+      // All relocate moves.
+      sym_relocate_gain = sym_ls.perform_all_relocate_steps();
+
+      // All or-opt moves.
+      sym_or_opt_gain = sym_ls.perform_all_or_opt_steps();
+
+      sym_cost -= sym_two_opt_gain + sym_relocate_gain + sym_or_opt_gain;
+    } while ((sym_two_opt_gain > 0) or (sym_relocate_gain > 0) or
+             (sym_or_opt_gain > 0));
+
+    current_sol = sym_ls.get_tour(first_loc_index);
+    current_cost = this->symmetrized_cost(current_sol);
+
+    auto end_sym_local_search = std::chrono::high_resolution_clock::now();
+
+    auto sym_local_search_duration =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+        end_sym_local_search - start_sym_local_search)
+        .count();
+    BOOST_LOG_TRIVIAL(info)
+      << "[TSP] Done in " << sym_local_search_duration
+      << " ms, symmetric solution cost is now " << current_cost << " ("
+      << std::fixed << std::setprecision(2)
+      << 100 * (((double)current_cost) / heuristic_cost - 1) << "%).";
+  }
 
   auto asym_local_search_duration = 0;
 
-  if (!_is_symmetric) {
+  if (!_is_symmetric and construction != CONSTRUCTION_T::HELD_KARP) {
     auto start_asym_local_search = std::chrono::high_resolution_clock::now();
 
     // Back to the asymmetric problem, picking the best way.
-    std::list<index_t> reverse_current_sol(current_sol);
-    reverse_current_sol.reverse();
-    cost_t direct_cost = this->cost(current_sol);
-    cost_t reverse_cost = this->cost(reverse_current_sol);
+    cost_t direct_cost = current_sol.cost(m);
+    cost_t reverse_cost = current_sol.reverse_cost(m);
+    if (reverse_cost < direct_cost) {
+      current_sol.reverse();
+    }
 
-    // Cost reference after symmetric local search.
+    // Cost reference before asymmetric local search.
     cost_t sym_ls_cost = std::min(direct_cost, reverse_cost);
 
     // Local search on asymmetric problem.
-    local_search asym_ls(_matrix,
-                         false, // Not the symmetrized problem.
-                         (direct_cost <= reverse_cost) ? current_sol
-                                                       : reverse_current_sol,
-                         nb_threads);
+    local_search<Matrix> asym_ls(m,
+                                 false, // Not the symmetrized problem.
+                                 current_sol,
+                                 executor);
 
     BOOST_LOG_TRIVIAL(info) << "[TSP] Back to asymmetric "
                                "problem, initial solution cost is "
                             << sym_ls_cost << ".";
 
     BOOST_LOG_TRIVIAL(info)
-      << "[TSP] Start local search on asymmetric problem using " << nb_threads
-      << " thread(s).";
+      << "[TSP] Start local search on asymmetric problem using "
+      << executor.size() << " thread(s).";
 
     cost_t asym_two_opt_gain = 0;
     cost_t asym_relocate_gain = 0;
     cost_t asym_or_opt_gain = 0;
     cost_t asym_avoid_loops_gain = 0;
+    cost_t asym_cost = sym_ls_cost;
 
     do {
+      if (gap_reached(asym_cost)) {
+        break;
+      }
+
       // All avoid-loops moves.
       asym_avoid_loops_gain = asym_ls.perform_all_avoid_loop_steps();
 
@@ -274,11 +676,14 @@ solution tsp::solve(unsigned nb_threads) const {
 
       // All or-opt moves.
       asym_or_opt_gain = asym_ls.perform_all_or_opt_steps();
+
+      asym_cost -= asym_avoid_loops_gain + asym_two_opt_gain +
+                   asym_relocate_gain + asym_or_opt_gain;
     } while ((asym_two_opt_gain > 0) or (asym_relocate_gain > 0) or
              (asym_or_opt_gain > 0) or (asym_avoid_loops_gain > 0));
 
     current_sol = asym_ls.get_tour(first_loc_index);
-    current_cost = this->cost(current_sol);
+    current_cost = current_sol.cost(m);
 
     auto end_asym_local_search = std::chrono::high_resolution_clock::now();
 
@@ -293,53 +698,24 @@ solution tsp::solve(unsigned nb_threads) const {
       << 100 * (((double)current_cost) / sym_ls_cost - 1) << "%).";
   }
 
-  // Deal with open tour cases requiring adaptation.
-  if (!_has_start and _has_end) {
-    // The tour has been listed starting with the "forced" end. This
-    // index has to be popped and put back, the next element being the
-    // chosen start resulting from the optimization.
-    current_sol.push_back(current_sol.front());
-    current_sol.pop_front();
-  }
-
-  // Steps for the one route.
-  std::vector<step> steps;
-
-  // Handle start.
-  auto job_start = current_sol.cbegin();
-  if (_has_start) {
-    // Add start step.
-    assert(current_sol.front() == _start);
-    steps.emplace_back(TYPE::START,
-                       _input._vehicles[_vehicle_rank].start.get());
-    // Remember that jobs start further away in the list.
-    ++job_start;
-  }
-  // Determine where to stop for last job.
-  auto job_end = current_sol.cend();
-
-  if (!_round_trip and _has_end) {
-    --job_end;
+  if (!early_bound and construction != CONSTRUCTION_T::HELD_KARP) {
+    const uint64_t n = _matrix_ranks.size();
+    const auto nb_iterations =
+      std::min<uint64_t>(LOWER_BOUND_ITERATIONS,
+                         REPORTED_BOUND_MAX_WORK / (n * n));
+    if (nb_iterations >= REPORTED_BOUND_MIN_ITERATIONS) {
+      compute_bound(current_cost, nb_iterations);
+    } else {
+      BOOST_LOG_TRIVIAL(info) << "[TSP] Skipping lower bound.";
+    }
   }
 
-  // Handle jobs.
-  for (auto job = job_start; job != job_end; ++job) {
-    auto current_rank = _job_ranks[*job];
-    steps.emplace_back(TYPE::JOB,
-                       _input._jobs[current_rank],
-                       _input._jobs[current_rank].id);
+  if (bound > 0) {
+    BOOST_LOG_TRIVIAL(info) << "[TSP] Gap to lower bound is " << std::fixed
+                            << std::setprecision(2)
+                            << 100 * (((double)current_cost) / bound - 1)
+                            << "%.";
   }
-  // Handle end.
-  if (_has_end) {
-    // Add end step.
-    steps.emplace_back(TYPE::END, _input._vehicles[_vehicle_rank].end.get());
-  }
-
-  // Route.
-  std::vector<route_t> routes;
-  routes.emplace_back(_input._vehicles[_vehicle_rank].id, steps, current_cost);
 
-  solution sol(0, current_cost, std::move(routes), std::vector<job_t>());
-
-  return sol;
+  return {std::move(current_sol), current_cost, bound};
 }
@@ -13,36 +13,126 @@ All rights reserved (see LICENSE).
 #include <fstream>
 #include <iomanip>
 #include <iostream>
-#include <list>
+#include <numeric>
 #include <string>
 
+#include "../../algorithms/one_tree.h"
+#include "../../structures/abstract/min_view.h"
+#include "../../structures/abstract/tour.h"
 #include "../../structures/abstract/undirected_graph.h"
+#include "../../utils/task_executor.h"
 #include "../vrp.h"
+#include "./heuristics/assignment_patching.h"
+#include "./heuristics/candidates.h"
 #include "./heuristics/christofides.h"
+#include "./heuristics/greedy.h"
+#include "./heuristics/held_karp.h"
 #include "./heuristics/local_search.h"
+#include "./heuristics/nearest_neighbour.h"
+#include "./heuristics/space_filling_curve.h"
+#include "./tour_cost.h"
+#include "./tsp_cache.h"
+
+// Above this degree of asymmetry (see tsp::_asymmetry), building a
+// tour on the symmetrized problem is not worth it and construction
+// is done directly on the asymmetric problem.
+constexpr double ASYMMETRIC_CONSTRUCTION_THRESHOLD = 0.5;
+
+// From these sizes, CONSTRUCTION_T::AUTO respectively switches to
+// christofides on the candidate graph and to the greedy heuristic
+// over nearest candidates.
+constexpr index_t SPARSE_CONSTRUCTION_THRESHOLD = 2000;
+constexpr index_t FAST_CONSTRUCTION_THRESHOLD = 5000;
+
+// Up to this size, CONSTRUCTION_T::AUTO solves to optimality using
+// Held-Karp. Above the max size, requiring Held-Karp falls back to
+// automatic construction as memory use doubles with each location.
+constexpr index_t HELD_KARP_THRESHOLD = 14;
+constexpr index_t HELD_KARP_MAX_SIZE = 20;
+
+// Subgradient iterations for the Held-Karp lower bound.
+constexpr unsigned LOWER_BOUND_ITERATIONS = 50;
+
+// Without gap threshold, the lower bound is only used to report the
+// gap, so its iterations are capped to keep the number of costs read
+// under this budget. The bound is skipped if it would get fewer than
+// the min number of iterations.
+constexpr uint64_t REPORTED_BOUND_MAX_WORK = 50000000;
+constexpr unsigned REPORTED_BOUND_MIN_ITERATIONS = 10;
+
+// Sizes using fast construction are meant to start local search
+// right away and to never pay for a bound only used for reporting.
+static_assert(REPORTED_BOUND_MAX_WORK /
+                  (static_cast<uint64_t>(FAST_CONSTRUCTION_THRESHOLD) *
+                   FAST_CONSTRUCTION_THRESHOLD) <
+                REPORTED_BOUND_MIN_ITERATIONS,
+              "Reported lower bound computed with fast construction.");
+
+// Side of the square tiles used to read costs in both directions
+// when symmetrizing.
+constexpr index_t SYMMETRIZATION_TILE_SIZE = 32;
 
 class tsp : public vrp {
 private:
   index_t _vehicle_rank;
-  // Holds the matching from index in _matrix to rank in input::_jobs.
+  // Holds the matching from TSP index to rank in input::_jobs.
   std::vector<index_t> _job_ranks;
   bool _is_symmetric;
+  // Average over jobs of (m[j][i] - m[i][j]) / (m[i][j] + m[j][i])
+  // where j is the cheapest job to go to from i. Close to 0 when
+  // symmetrizing is harmless, close to 1 when cheap ways out are
+  // expensive ways back.
+  double _asymmetry;
   bool _has_start;
   index_t _start;
   bool _has_end;
   index_t _end;
-  matrix<cost_t> _matrix;
+  // Holds the matching from TSP index to index in input matrix.
+  std::vector<index_t> _matrix_ranks;
+  TOUR_T _tour_type;
   matrix<cost_t> _symmetrized_matrix;
   bool _round_trip;
 
+  // Call f with the cost policy matching _tour_type, so that open
+  // tours are handled without copying and rewriting the input
+  // matrix.
+  template <class Function> auto with_cost_policy(Function f) const;
+
+  // Fill coordinates in TSP index order, return false if some
+  // location has none.
+  bool get_coordinates(std::vector<coords_t>& coordinates) const;
+
+  // Fill _symmetrized_matrix, _is_symmetric and _asymmetry in a
+  // single pass over m.
+  template <class Matrix> void symmetrize(const Matrix& m);
+
+  // Lower bound on the cost of any tour, computed on costs
+  // symmetrized with min so that it holds for the actual problem.
+  cost_t lower_bound(cost_t upper_bound, unsigned nb_iterations) const;
+
+  // Cache key, with key_ranks[p] set to the TSP index of the p-th
+  // job in key order.
+  tsp_key cache_key(std::vector<index_t>& key_ranks) const;
+
+  // Tour over TSP indices, along with its cost and lower bound.
+  template <class Matrix>
+  tsp_result solve_tour(const Matrix& m,
+                        task_executor& executor,
+                        unsigned nb_threads) const;
+
 public:
   tsp(const input& input, std::vector<index_t> job_ranks, index_t vehicle_rank);
 
-  cost_t cost(const std::list<index_t>& tour) const;
+  cost_t cost(const tour_t& tour) const;
 
-  cost_t symmetrized_cost(const std::list<index_t>& tour) const;
+  cost_t symmetrized_cost(const tour_t& tour) const;
 
   virtual solution solve(unsigned nb_threads) const override;
+
+  // Local search runs as tasks on executor while construction uses
+  // up to nb_threads threads of its own, so that solving several TSP
+  // concurrently can share threads.
+  solution solve(task_executor& executor, unsigned nb_threads) const;
 };
 
 #endif
@@ -0,0 +1,91 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <functional>
+
+#include "tsp_cache.h"
+
+tsp_key::tsp_key(TOUR_T tour_type,
+                 std::vector<index_t> indices,
+                 uint64_t costs_hash,
+                 CONSTRUCTION_T construction,
+                 double gap_threshold)
+  : tour_type(tour_type),
+    indices(std::move(indices)),
+    costs_hash(costs_hash),
+    construction(construction),
+    gap_threshold(gap_threshold),
+    hash(costs_hash) {
+  auto combine = [this](std::size_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+  };
+  combine(static_cast<std::size_t>(tour_type));
+  combine(static_cast<std::size_t>(construction));
+  combine(std::hash<double>()(gap_threshold));
+  for (auto i : this->indices) {
+    combine(i);
+  }
+}
+
+bool tsp_key::operator==(const tsp_key& other) const {
+  return hash == other.hash and costs_hash == other.costs_hash and
+         tour_type == other.tour_type and
+         construction == other.construction and
+         gap_threshold == other.gap_threshold and indices == other.indices;
+}
+
+tsp_cache::tsp_cache(std::size_t capacity) : _capacity(capacity), _size(0) {
+}
+
+tsp_cache& tsp_cache::shared() {
+  static tsp_cache cache;
+  return cache;
+}
+
+void tsp_cache::evict() {
+  while (_size > _capacity) {
+    auto& last = _entries.back();
+    _size -= last.bytes;
+    _index.erase(&last.key);
+    _entries.pop_back();
+  }
+}
+
+void tsp_cache::set_capacity(std::size_t capacity) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _capacity = capacity;
+  evict();
+}
+
+bool tsp_cache::find(const tsp_key& key, tsp_result& result) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto search = _index.find(&key);
+  if (search == _index.end()) {
+    return false;
+  }
+  _entries.splice(_entries.begin(), _entries, search->second);
+  result = search->second->result;
+  return true;
+}
+
+void tsp_cache::insert(tsp_key key, tsp_result result) {
+  // Entry along with list and index nodes overhead.
+  std::size_t bytes = sizeof(entry) + 4 * sizeof(void*) +
+                      (key.indices.size() + result.tour.size()) *
+                        sizeof(index_t);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (bytes > _capacity or _index.find(&key) != _index.end()) {
+    return;
+  }
+  _entries.push_front({std::move(key), std::move(result), bytes});
+  _index.emplace(&_entries.front().key, _entries.begin());
+  _size += bytes;
+  evict();
+}
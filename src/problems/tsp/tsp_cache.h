@@ -0,0 +1,105 @@
+#ifndef TSP_CACHE_H
+#define TSP_CACHE_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "../../structures/abstract/tour.h"
+#include "../../structures/typedefs.h"
+#include "./tour_cost.h"
+
+// Default memory cap for cached TSP results, in bytes.
+constexpr std::size_t TSP_CACHE_CAPACITY = 64 * 1024 * 1024;
+
+// Identifies a TSP by its content rather than by job ranks or ids:
+// tour type, sorted job locations followed by start and/or end
+// locations, a hash of costs between them and solving options.
+struct tsp_key {
+  TOUR_T tour_type;
+  std::vector<index_t> indices;
+  uint64_t costs_hash;
+  CONSTRUCTION_T construction;
+  double gap_threshold;
+  std::size_t hash;
+
+  tsp_key(TOUR_T tour_type,
+          std::vector<index_t> indices,
+          uint64_t costs_hash,
+          CONSTRUCTION_T construction,
+          double gap_threshold);
+
+  bool operator==(const tsp_key& other) const;
+};
+
+// Tour over locations numbered in key order, along with its cost and
+// the lower bound computed while solving.
+struct tsp_result {
+  tour_t tour;
+  cost_t cost;
+  cost_t lower_bound;
+};
+
+// Thread-safe cache of TSP results with least recently used
+// eviction once the memory cap is reached. A shared instance lives
+// as long as the process so that results are reused across solves.
+class tsp_cache {
+private:
+  struct entry {
+    tsp_key key;
+    tsp_result result;
+    std::size_t bytes;
+  };
+
+  struct key_hash {
+    std::size_t operator()(const tsp_key* key) const {
+      return key->hash;
+    }
+  };
+
+  struct key_equal {
+    bool operator()(const tsp_key* lhs, const tsp_key* rhs) const {
+      return *lhs == *rhs;
+    }
+  };
+
+  std::mutex _mutex;
+  std::size_t _capacity;
+  std::size_t _size;
+  // Most recently used first, indexed by keys stored in entries.
+  std::list<entry> _entries;
+  std::unordered_map<const tsp_key*,
+                     std::list<entry>::iterator,
+                     key_hash,
+                     key_equal>
+    _index;
+
+  // Drop least recently used entries until under capacity.
+  void evict();
+
+public:
+  tsp_cache(std::size_t capacity = TSP_CACHE_CAPACITY);
+
+  static tsp_cache& shared();
+
+  // Setting capacity to 0 disables caching.
+  void set_capacity(std::size_t capacity);
+
+  // Copy cached result for key if any.
+  bool find(const tsp_key& key, tsp_result& result);
+
+  void insert(tsp_key key, tsp_result result);
+};
+
+#endif
@@ -0,0 +1,43 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+#include <cstdint>
+
+#include "./arena.h"
+
+arena::arena()
+  : _current(nullptr),
+    _remaining(0),
+    _next_block_size(ARENA_INITIAL_BLOCK_SIZE) {
+}
+
+void* arena::allocate(std::size_t bytes, std::size_t alignment) {
+  auto padding = [&]() {
+    const auto address = reinterpret_cast<std::uintptr_t>(_current);
+    return (alignment - address % alignment) % alignment;
+  };
+
+  if (_current == nullptr or padding() + bytes > _remaining) {
+    // Current block is exhausted, moving on to a new one large enough
+    // for this allocation.
+    const std::size_t block_size =
+      std::max(_next_block_size, bytes + alignment);
+    _blocks.emplace_back(new char[block_size]);
+    _current = _blocks.back().get();
+    _remaining = block_size;
+    _next_block_size = 2 * block_size;
+  }
+
+  const std::size_t offset = padding() + bytes;
+  void* allocated = _current + (offset - bytes);
+  _current += offset;
+  _remaining -= offset;
+  return allocated;
+}
@@ -0,0 +1,91 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <functional>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// Size of the first block reserved by an arena, next blocks doubling
+// in size.
+constexpr std::size_t ARENA_INITIAL_BLOCK_SIZE = 16 * 1024;
+
+// Monotonic memory arena: allocations are carved out of large blocks
+// and are never released individually, all blocks being released at
+// once on destruction. Used for short-lived node-based containers so
+// that each node does not require a call to the global allocator. An
+// arena is not thread-safe and should only be used by one thread.
+class arena {
+private:
+  std::vector<std::unique_ptr<char[]>> _blocks;
+  char* _current;
+  std::size_t _remaining;
+  std::size_t _next_block_size;
+
+public:
+  arena();
+
+  arena(const arena&) = delete;
+
+  arena& operator=(const arena&) = delete;
+
+  void* allocate(std::size_t bytes, std::size_t alignment);
+};
+
+// Standard allocator drawing from an arena, deallocation being a
+// no-op. Implicitly built from an arena so that containers can be
+// constructed directly from one.
+template <class T> class arena_allocator {
+private:
+  template <class U> friend class arena_allocator;
+
+  arena* _arena;
+
+public:
+  using value_type = T;
+
+  arena_allocator(arena& memory) : _arena(&memory) {
+  }
+
+  template <class U>
+  arena_allocator(const arena_allocator<U>& other) : _arena(other._arena) {
+  }
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, std::size_t) {
+  }
+
+  template <class U> bool operator==(const arena_allocator<U>& other) const {
+    return _arena == other._arena;
+  }
+
+  template <class U> bool operator!=(const arena_allocator<U>& other) const {
+    return _arena != other._arena;
+  }
+};
+
+template <class Key, class T>
+using arena_unordered_map =
+  std::unordered_map<Key,
+                     T,
+                     std::hash<Key>,
+                     std::equal_to<Key>,
+                     arena_allocator<std::pair<const Key, T>>>;
+
+template <class Key>
+using arena_set = std::set<Key, std::less<Key>, arena_allocator<Key>>;
+
+#endif
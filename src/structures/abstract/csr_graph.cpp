@@ -0,0 +1,94 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+#include <cassert>
+
+#include "csr_graph.h"
+
+template <class T>
+csr_graph::csr_graph(const std::vector<edge<T>>& edges,
+                     std::size_t nb_vertices)
+  : _offsets(nb_vertices + 1, 0),
+    _neighbors(2 * edges.size()),
+    _edge_ranks(2 * edges.size()),
+    _used(edges.size(), false) {
+  // Count degrees then turn them into offsets.
+  for (const auto& e : edges) {
+    assert(e.get_second_vertex() < nb_vertices);
+    ++_offsets[e.get_first_vertex() + 1];
+    ++_offsets[e.get_second_vertex() + 1];
+  }
+  for (std::size_t v = 0; v < nb_vertices; ++v) {
+    _offsets[v + 1] += _offsets[v];
+  }
+
+  std::vector<unsigned> position(_offsets.begin(), _offsets.end() - 1);
+  for (unsigned rank = 0; rank < edges.size(); ++rank) {
+    index_t first = edges[rank].get_first_vertex();
+    index_t second = edges[rank].get_second_vertex();
+
+    _neighbors[position[first]] = second;
+    _edge_ranks[position[first]++] = rank;
+    _neighbors[position[second]] = first;
+    _edge_ranks[position[second]++] = rank;
+  }
+}
+
+std::size_t csr_graph::size() const {
+  return _offsets.size() - 1;
+}
+
+std::size_t csr_graph::nb_edges() const {
+  return _used.size();
+}
+
+unsigned csr_graph::degree(index_t v) const {
+  return _offsets[v + 1] - _offsets[v];
+}
+
+std::vector<index_t> csr_graph::eulerian_circuit(index_t start) {
+  std::fill(_used.begin(), _used.end(), false);
+
+  // Next position to look at in _neighbors for each vertex.
+  std::vector<unsigned> next(_offsets.begin(), _offsets.end() - 1);
+
+  std::vector<index_t> circuit;
+  circuit.reserve(nb_edges() + 1);
+
+  // Walking along unused edges from the top of the stack, vertices
+  // with no unused edge left are popped to the circuit. This joins
+  // closed sub-tours as they are found.
+  std::vector<index_t> stack;
+  stack.reserve(nb_edges() + 1);
+  stack.push_back(start);
+
+  while (!stack.empty()) {
+    index_t v = stack.back();
+    unsigned& k = next[v];
+    while (k < _offsets[v + 1] and _used[_edge_ranks[k]]) {
+      ++k;
+    }
+
+    if (k == _offsets[v + 1]) {
+      circuit.push_back(v);
+      stack.pop_back();
+    } else {
+      _used[_edge_ranks[k]] = true;
+      stack.push_back(_neighbors[k]);
+      ++k;
+    }
+  }
+  assert(circuit.size() == nb_edges() + 1);
+
+  return circuit;
+}
+
+template csr_graph::csr_graph(const std::vector<edge<cost_t>>& edges,
+                              std::size_t nb_vertices);
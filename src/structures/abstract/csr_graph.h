@@ -0,0 +1,45 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <vector>
+
+#include "edge.h"
+
+// Undirected multigraph in compressed sparse row form: neighbors of
+// vertex v are stored in _neighbors between _offsets[v] and
+// _offsets[v + 1], along with the rank of the matching edge. Each
+// edge appears twice and has a single used flag.
+class csr_graph {
+
+private:
+  std::vector<unsigned> _offsets;
+  std::vector<index_t> _neighbors;
+  std::vector<unsigned> _edge_ranks;
+  std::vector<unsigned char> _used;
+
+public:
+  template <class T>
+  csr_graph(const std::vector<edge<T>>& edges, std::size_t nb_vertices);
+
+  std::size_t size() const;
+
+  std::size_t nb_edges() const;
+
+  unsigned degree(index_t v) const;
+
+  // Iterative Hierholzer algorithm in O(E), marking all edges as
+  // used. Returns the vertices of an eulerian circuit starting and
+  // ending at start. The graph has to be connected with even degrees.
+  std::vector<index_t> eulerian_circuit(index_t start);
+};
+
+#endif
@@ -0,0 +1,95 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <cassert>
+
+#include "./indexed_heap.h"
+
+constexpr uint32_t indexed_heap::NOT_IN_HEAP;
+
+indexed_heap::indexed_heap(std::size_t capacity)
+  : _positions(capacity, NOT_IN_HEAP), _scores(capacity, 0) {
+}
+
+void indexed_heap::sift_up(uint32_t position) {
+  const index_t item = _heap[position];
+  while (position > 0) {
+    const uint32_t parent = (position - 1) / 2;
+    if (!before(item, _heap[parent])) {
+      break;
+    }
+    place(_heap[parent], position);
+    position = parent;
+  }
+  place(item, position);
+}
+
+void indexed_heap::sift_down(uint32_t position) {
+  const index_t item = _heap[position];
+  const uint32_t size = _heap.size();
+  while (true) {
+    uint32_t child = 2 * position + 1;
+    if (child >= size) {
+      break;
+    }
+    if (child + 1 < size and before(_heap[child + 1], _heap[child])) {
+      ++child;
+    }
+    if (!before(_heap[child], item)) {
+      break;
+    }
+    place(_heap[child], position);
+    position = child;
+  }
+  place(item, position);
+}
+
+void indexed_heap::push(index_t item, double score) {
+  assert(!contains(item));
+  _scores[item] = score;
+  _heap.push_back(item);
+  _positions[item] = _heap.size() - 1;
+  sift_up(_heap.size() - 1);
+}
+
+void indexed_heap::pop() {
+  assert(!_heap.empty());
+  erase(_heap.front());
+}
+
+void indexed_heap::erase(index_t item) {
+  assert(contains(item));
+  const uint32_t position = _positions[item];
+  _positions[item] = NOT_IN_HEAP;
+
+  const index_t last = _heap.back();
+  _heap.pop_back();
+  if (position == _heap.size()) {
+    // Removed item was the last one.
+    return;
+  }
+
+  place(last, position);
+  if (position > 0 and before(last, _heap[(position - 1) / 2])) {
+    sift_up(position);
+  } else {
+    sift_down(position);
+  }
+}
+
+void indexed_heap::update(index_t item, double score) {
+  assert(contains(item));
+  const double previous = _scores[item];
+  _scores[item] = score;
+  if (score > previous) {
+    sift_up(_positions[item]);
+  } else if (score < previous) {
+    sift_down(_positions[item]);
+  }
+}
@@ -0,0 +1,88 @@
+#ifndef INDEXED_HEAP_H
+#define INDEXED_HEAP_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "../typedefs.h"
+
+// Addressable binary max-heap on items in [0, capacity) with a
+// stored score for each item. The position of each item in the heap
+// is maintained so that scores can be updated and items removed in
+// O(log n). Ties on scores are broken in favor of smaller items.
+class indexed_heap {
+private:
+  static constexpr uint32_t NOT_IN_HEAP = std::numeric_limits<uint32_t>::max();
+
+  std::vector<index_t> _heap;
+  std::vector<uint32_t> _positions;
+  std::vector<double> _scores;
+
+  bool before(index_t lhs, index_t rhs) const {
+    return _scores[lhs] > _scores[rhs] or
+           (_scores[lhs] == _scores[rhs] and lhs < rhs);
+  }
+
+  void place(index_t item, uint32_t position) {
+    _heap[position] = item;
+    _positions[item] = position;
+  }
+
+  void sift_up(uint32_t position);
+
+  void sift_down(uint32_t position);
+
+public:
+  indexed_heap(std::size_t capacity);
+
+  bool empty() const {
+    return _heap.empty();
+  }
+
+  std::size_t size() const {
+    return _heap.size();
+  }
+
+  bool contains(index_t item) const {
+    return _positions[item] != NOT_IN_HEAP;
+  }
+
+  // Item with highest score.
+  index_t top() const {
+    return _heap.front();
+  }
+
+  double score(index_t item) const {
+    return _scores[item];
+  }
+
+  // Items in heap order, only valid until next modification.
+  std::vector<index_t>::const_iterator begin() const {
+    return _heap.cbegin();
+  }
+
+  std::vector<index_t>::const_iterator end() const {
+    return _heap.cend();
+  }
+
+  void push(index_t item, double score);
+
+  void pop();
+
+  void erase(index_t item);
+
+  // Set a new score for an item in the heap, either higher or lower.
+  void update(index_t item, double score);
+};
+
+#endif
@@ -43,6 +43,12 @@ public:
   matrix(std::initializer_list<line<T>> l);
 
   matrix<T> get_sub_matrix(const std::vector<index_t>& indices) const;
+
+  // Element access allowing a matrix to be used wherever a cost
+  // policy is expected. Defined here to be inlined in hot loops.
+  T operator()(index_t i, index_t j) const {
+    return (*this)[i][j];
+  }
 };
 
 #endif
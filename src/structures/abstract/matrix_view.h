@@ -0,0 +1,40 @@
+#ifndef MATRIX_VIEW_H
+#define MATRIX_VIEW_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <vector>
+
+#include "./matrix.h"
+
+// Read-only view on the rows and columns of a matrix matching
+// indices, used in place of a sub-matrix copy. Both the matrix and
+// the indices are referenced and should outlive the view. Access is
+// defined in the header to be inlined in hot loops.
+template <class T> class matrix_view {
+private:
+  const matrix<T>& _matrix;
+  const std::vector<index_t>& _indices;
+
+public:
+  matrix_view(const matrix<T>& m, const std::vector<index_t>& indices)
+    : _matrix(m), _indices(indices) {
+  }
+
+  std::size_t size() const {
+    return _indices.size();
+  }
+
+  T operator()(index_t i, index_t j) const {
+    return _matrix[_indices[i]][_indices[j]];
+  }
+};
+
+#endif
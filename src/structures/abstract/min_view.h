@@ -0,0 +1,37 @@
+#ifndef MIN_VIEW_H
+#define MIN_VIEW_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+
+#include "../typedefs.h"
+
+// Read-only symmetric view on costs provided by View, taking the
+// minimum of both directions, used in place of a symmetrized copy.
+// The underlying view is referenced and should outlive this one.
+template <class View> class min_view {
+private:
+  const View& _view;
+
+public:
+  min_view(const View& view) : _view(view) {
+  }
+
+  std::size_t size() const {
+    return _view.size();
+  }
+
+  cost_t operator()(index_t i, index_t j) const {
+    return std::min(_view(i, j), _view(j, i));
+  }
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef PENALIZED_MATRIX_H
+#define PENALIZED_MATRIX_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <vector>
+
+#include "./matrix.h"
+
+// Read-only view on the first size rows and columns of a matrix,
+// with a penalty added to costs for both ends of each edge as in
+// Held-Karp lower bound computation. The matrix and penalties are
+// referenced and should outlive the view.
+template <class Matrix> class penalized_matrix {
+private:
+  const Matrix& _matrix;
+  const std::vector<double>& _penalties;
+  const std::size_t _size;
+
+public:
+  penalized_matrix(const Matrix& m,
+                   const std::vector<double>& penalties,
+                   std::size_t size)
+    : _matrix(m), _penalties(penalties), _size(size) {
+  }
+
+  std::size_t size() const {
+    return _size;
+  }
+
+  double operator()(index_t i, index_t j) const {
+    return _matrix(i, j) + _penalties[i] + _penalties[j];
+  }
+};
+
+#endif
@@ -0,0 +1,26 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+#include <cassert>
+
+#include "tour.h"
+
+tour_t::tour_t() : parent() {
+}
+
+void tour_t::rotate_to(index_t first_index) {
+  auto first = std::find(this->begin(), this->end(), first_index);
+  assert(first != this->end());
+  std::rotate(this->begin(), first, this->end());
+}
+
+void tour_t::reverse() {
+  std::reverse(this->begin(), this->end());
+}
@@ -0,0 +1,84 @@
+#ifndef TOUR_H
+#define TOUR_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <vector>
+
+#include "../typedefs.h"
+
+// Contiguous description of a tour as the ordered list of visited
+// indices, the last one being implicitly linked back to the first.
+class tour_t : private std::vector<index_t> {
+
+  using parent = std::vector<index_t>;
+
+public:
+  tour_t();
+
+  using parent::back;
+  using parent::begin;
+  using parent::cbegin;
+  using parent::cend;
+  using parent::clear;
+  using parent::empty;
+  using parent::end;
+  using parent::front;
+  using parent::push_back;
+  using parent::reserve;
+  using parent::size;
+  using parent::operator[];
+
+  // Rotate tour in place so that it is described from first_index.
+  void rotate_to(index_t first_index);
+
+  // Reverse tour direction in place.
+  void reverse();
+
+  // Cost of going through the tour, closing edge included. Matrix
+  // is either a plain matrix or a cost policy.
+  template <class Matrix> cost_t cost(const Matrix& m) const;
+
+  // Cost of going through the tour in reverse order, closing edge
+  // included.
+  template <class Matrix> cost_t reverse_cost(const Matrix& m) const;
+};
+
+template <class Matrix> cost_t tour_t::cost(const Matrix& m) const {
+  if (this->empty()) {
+    return 0;
+  }
+
+  // Plain indexed loop over contiguous indices, last step links
+  // back to the first one.
+  const index_t* steps = this->data();
+  const std::size_t last = this->size() - 1;
+  cost_t cost = m(steps[last], steps[0]);
+  for (std::size_t i = 0; i < last; ++i) {
+    cost += m(steps[i], steps[i + 1]);
+  }
+  return cost;
+}
+
+template <class Matrix> cost_t tour_t::reverse_cost(const Matrix& m) const {
+  if (this->empty()) {
+    return 0;
+  }
+
+  const index_t* steps = this->data();
+  const std::size_t last = this->size() - 1;
+  cost_t cost = m(steps[0], steps[last]);
+  for (std::size_t i = 0; i < last; ++i) {
+    cost += m(steps[i + 1], steps[i]);
+  }
+  return cost;
+}
+
+#endif
@@ -49,7 +49,7 @@ template <class T> std::vector<edge<T>> undirected_graph<T>::get_edges() const {
 }
 
 template <class T>
-std::unordered_map<index_t, std::list<index_t>>
+const std::unordered_map<index_t, std::list<index_t>>&
 undirected_graph<T>::get_adjacency_list() const {
   return _adjacency_list;
 }
@@ -38,7 +38,8 @@ public:
 
   std::vector<edge<T>> get_edges() const;
 
-  std::unordered_map<index_t, std::list<index_t>> get_adjacency_list() const;
+  const std::unordered_map<index_t, std::list<index_t>>&
+  get_adjacency_list() const;
 };
 
 #endif
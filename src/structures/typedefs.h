@@ -33,6 +33,19 @@ using optional_coords_t = boost::optional<coords_t>;
 // Setting max value would cause trouble with further additions.
 constexpr cost_t INFINITE_COST = 3 * (std::numeric_limits<cost_t>::max() / 4);
 
+// Tour construction heuristics for TSP. AUTO picks one based on
+// problem size and asymmetry.
+enum class CONSTRUCTION_T {
+  AUTO,
+  CHRISTOFIDES,
+  SPARSE_CHRISTOFIDES,
+  ASSIGNMENT_PATCHING,
+  SPACE_FILLING_CURVE,
+  GREEDY,
+  NEAREST_NEIGHBOUR,
+  HELD_KARP
+};
+
 struct cl_args_t {
   // Listing command-line options.
   std::string osrm_address;                      // -a
@@ -45,6 +58,12 @@ struct cl_args_t {
   std::string input;                             // cl arg
   unsigned nb_threads;                           // -t
   std::string osrm_profile;                      // -m
+  CONSTRUCTION_T construction;                   // -c
+  double gap_threshold;                          // -b
+  unsigned evaluated_clusterings;                // -k
+  unsigned evaluation_budget;                    // -d
+  std::string clustering_stats_file;             // -f
+  unsigned max_clusterings;                      // -n
   // Default values.
   cl_args_t()
     : osrm_address("0.0.0.0"),
@@ -53,7 +72,12 @@ struct cl_args_t {
       use_libosrm(false),
       log_level(boost::log::trivial::error),
       nb_threads(2),
-      osrm_profile("car") {
+      osrm_profile("car"),
+      construction(CONSTRUCTION_T::AUTO),
+      gap_threshold(0),
+      evaluated_clusterings(1),
+      evaluation_budget(0),
+      max_clusterings(0) {
   }
 };
 
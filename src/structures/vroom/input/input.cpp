@@ -14,7 +14,12 @@ input::input(std::unique_ptr<routing_io<cost_t>> routing_wrapper, bool geometry)
   : _start_loading(std::chrono::high_resolution_clock::now()),
     _routing_wrapper(std::move(routing_wrapper)),
     _has_capacity(false),
-    _geometry(geometry) {
+    _geometry(geometry),
+    _construction(CONSTRUCTION_T::AUTO),
+    _gap_threshold(0),
+    _evaluated_clusterings(1),
+    _evaluation_budget(0),
+    _max_clusterings(0) {
 }
 
 void input::add_job(const job_t& job) {
@@ -117,6 +122,55 @@ const matrix<cost_t>& input::get_matrix() const {
   return _matrix;
 }
 
+void input::set_construction(CONSTRUCTION_T construction) {
+  _construction = construction;
+}
+
+CONSTRUCTION_T input::get_construction() const {
+  return _construction;
+}
+
+void input::set_gap_threshold(double gap_threshold) {
+  _gap_threshold = gap_threshold;
+}
+
+double input::get_gap_threshold() const {
+  return _gap_threshold;
+}
+
+void input::set_evaluated_clusterings(unsigned evaluated_clusterings) {
+  _evaluated_clusterings = evaluated_clusterings;
+}
+
+unsigned input::get_evaluated_clusterings() const {
+  return _evaluated_clusterings;
+}
+
+void input::set_evaluation_budget(unsigned evaluation_budget) {
+  _evaluation_budget = evaluation_budget;
+}
+
+unsigned input::get_evaluation_budget() const {
+  return _evaluation_budget;
+}
+
+void input::set_clustering_stats_file(
+  const std::string& clustering_stats_file) {
+  _clustering_stats_file = clustering_stats_file;
+}
+
+const std::string& input::get_clustering_stats_file() const {
+  return _clustering_stats_file;
+}
+
+void input::set_max_clusterings(unsigned max_clusterings) {
+  _max_clusterings = max_clusterings;
+}
+
+unsigned input::get_max_clusterings() const {
+  return _max_clusterings;
+}
+
 matrix<cost_t>
 input::get_sub_matrix(const std::vector<index_t>& indices) const {
   return _matrix.get_sub_matrix(indices);
@@ -48,6 +48,12 @@ private:
   bool _has_capacity;
   bool _has_skills;
   const bool _geometry;
+  CONSTRUCTION_T _construction;
+  double _gap_threshold;
+  unsigned _evaluated_clusterings;
+  unsigned _evaluation_budget;
+  std::string _clustering_stats_file;
+  unsigned _max_clusterings;
   matrix<cost_t> _matrix;
   std::vector<location_t> _locations;
   boost::optional<unsigned> _amount_size;
@@ -71,6 +77,30 @@ public:
 
   const matrix<cost_t>& get_matrix() const;
 
+  void set_construction(CONSTRUCTION_T construction);
+
+  CONSTRUCTION_T get_construction() const;
+
+  void set_gap_threshold(double gap_threshold);
+
+  double get_gap_threshold() const;
+
+  void set_evaluated_clusterings(unsigned evaluated_clusterings);
+
+  unsigned get_evaluated_clusterings() const;
+
+  void set_evaluation_budget(unsigned evaluation_budget);
+
+  unsigned get_evaluation_budget() const;
+
+  void set_clustering_stats_file(const std::string& clustering_stats_file);
+
+  const std::string& get_clustering_stats_file() const;
+
+  void set_max_clusterings(unsigned max_clusterings);
+
+  unsigned get_max_clusterings() const;
+
   matrix<cost_t> get_sub_matrix(const std::vector<index_t>& indices) const;
 
   PROBLEM_T get_problem_type() const;
@@ -78,6 +108,7 @@ public:
   solution solve(unsigned nb_thread);
 
   friend class clustering;
+  friend class clustering_context;
 };
 
 #endif
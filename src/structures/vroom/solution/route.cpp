@@ -14,5 +14,6 @@ route_t::route_t(ID_t vehicle, std::vector<step> steps, cost_t cost)
     steps(std::move(steps)),
     cost(cost),
     duration(0),
-    distance(0) {
+    distance(0),
+    lower_bound(0) {
 }
@@ -21,6 +21,8 @@ struct route_t {
   std::string geometry;
   duration_t duration;
   distance_t distance;
+  // Lower bound on the route cost for the same steps, 0 if unknown.
+  cost_t lower_bound;
 
   route_t(ID_t vehicle, std::vector<step> steps, cost_t cost);
 };
@@ -10,6 +10,9 @@ All rights reserved (see LICENSE).
 
 */
 
+#include <thread>
+#include <vector>
+
 #include "../structures/typedefs.h"
 #include "./exceptions.h"
 
@@ -21,4 +24,27 @@ inline cost_t add_without_overflow(cost_t a, cost_t b) {
   return a + b;
 }
 
+// Run f(begin, end) on nb_threads even ranges splitting [0, n), or
+// directly on the whole range when it is too small to be worth
+// spawning threads.
+template <class Function>
+void parallel_ranges(std::size_t n, unsigned nb_threads, Function f) {
+  if (nb_threads <= 1 or n < 2 * nb_threads) {
+    f(0, n);
+    return;
+  }
+  std::vector<std::thread> threads;
+  std::size_t range_width = n / nb_threads;
+  std::size_t remainder = n % nb_threads;
+  std::size_t begin = 0;
+  for (unsigned t = 0; t < nb_threads; ++t) {
+    std::size_t end = begin + range_width + ((t < remainder) ? 1 : 0);
+    threads.emplace_back(f, begin, end);
+    begin = end;
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
 #endif
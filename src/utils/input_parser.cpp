@@ -84,6 +84,12 @@ input parse(const cl_args_t& cl_args) {
 
   // Custom input object embedding jobs, vehicles and matrix.
   input input_data(std::move(routing_wrapper), cl_args.geometry);
+  input_data.set_construction(cl_args.construction);
+  input_data.set_gap_threshold(cl_args.gap_threshold);
+  input_data.set_evaluated_clusterings(cl_args.evaluated_clusterings);
+  input_data.set_evaluation_budget(cl_args.evaluation_budget);
+  input_data.set_clustering_stats_file(cl_args.clustering_stats_file);
+  input_data.set_max_clusterings(cl_args.max_clusterings);
 
   // Input json object.
   rapidjson::Document json_input;
@@ -72,6 +72,13 @@ rapidjson::Value to_json(const route_t& route,
 
   json_route.AddMember("vehicle", route.vehicle, allocator);
   json_route.AddMember("cost", route.cost, allocator);
+  if (route.lower_bound > 0) {
+    // Relative optimality gap.
+    json_route.AddMember("gap",
+                         static_cast<double>(route.cost) / route.lower_bound -
+                           1,
+                         allocator);
+  }
 
   if (!route.geometry.empty()) {
     json_route.AddMember("distance", route.distance, allocator);
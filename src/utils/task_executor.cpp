@@ -0,0 +1,174 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+
+#include "task_executor.h"
+
+// Executor and queue rank for pool threads.
+static thread_local const task_executor* current_executor = nullptr;
+static thread_local std::size_t current_rank = 0;
+// Group of the task running on current thread, if any.
+static thread_local const task_group* current_group = nullptr;
+
+task_group::task_group() : _nb_pending(0), _parent(nullptr) {
+}
+
+bool task_group::is_within(const task_group* group) const {
+  for (auto g = this; g != nullptr; g = g->_parent) {
+    if (g == group) {
+      return true;
+    }
+  }
+  return false;
+}
+
+task_executor::task_executor(unsigned nb_threads)
+  : _nb_queued(0), _nb_submitted(0), _stop(false) {
+  auto nb_queues = std::max(nb_threads, 1u);
+  for (std::size_t i = 0; i < nb_queues; ++i) {
+    _queues.emplace_back(new task_queue);
+  }
+  for (std::size_t rank = 1; rank < nb_queues; ++rank) {
+    _threads.emplace_back(&task_executor::work, this, rank);
+  }
+}
+
+task_executor::~task_executor() {
+  {
+    std::lock_guard<std::mutex> lock(_sleep_mutex);
+    _stop = true;
+  }
+  _wake_up.notify_all();
+  for (auto& t : _threads) {
+    t.join();
+  }
+}
+
+std::size_t task_executor::current_queue() const {
+  return (current_executor == this) ? current_rank : 0;
+}
+
+bool task_executor::pop_task(std::size_t rank,
+                             task& t,
+                             const task_group* group) {
+  auto eligible = [group](const task& candidate) {
+    return group == nullptr or candidate.group->is_within(group);
+  };
+
+  {
+    auto& own = *_queues[rank];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    auto search =
+      std::find_if(own.tasks.rbegin(), own.tasks.rend(), eligible);
+    if (search != own.tasks.rend()) {
+      t = std::move(*search);
+      own.tasks.erase(std::next(search).base());
+      --_nb_queued;
+      return true;
+    }
+  }
+  for (std::size_t i = 1; i < _queues.size(); ++i) {
+    auto& other = *_queues[(rank + i) % _queues.size()];
+    std::lock_guard<std::mutex> lock(other.mutex);
+    auto search =
+      std::find_if(other.tasks.begin(), other.tasks.end(), eligible);
+    if (search != other.tasks.end()) {
+      t = std::move(*search);
+      other.tasks.erase(search);
+      --_nb_queued;
+      return true;
+    }
+  }
+  return false;
+}
+
+void task_executor::run_task(task& t) {
+  auto previous_group = current_group;
+  current_group = t.group;
+  try {
+    t.run();
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(t.group->_exception_mutex);
+    if (!t.group->_exception) {
+      t.group->_exception = std::current_exception();
+    }
+  }
+  current_group = previous_group;
+
+  // Group may be destroyed as soon as its last task is done, so it is
+  // not accessed past this point.
+  if (--t.group->_nb_pending == 0) {
+    {
+      std::lock_guard<std::mutex> lock(_sleep_mutex);
+    }
+    _progress.notify_all();
+  }
+}
+
+void task_executor::work(std::size_t rank) {
+  current_executor = this;
+  current_rank = rank;
+
+  task t;
+  while (true) {
+    if (pop_task(rank, t, nullptr)) {
+      run_task(t);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(_sleep_mutex);
+    _wake_up.wait(lock, [&] { return _stop or _nb_queued > 0; });
+    if (_stop) {
+      return;
+    }
+  }
+}
+
+void task_executor::submit(task_group& group, std::function<void()> run) {
+  if (group._nb_pending++ == 0) {
+    group._parent = current_group;
+  }
+  {
+    auto& own = *_queues[current_queue()];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    own.tasks.push_back({std::move(run), &group});
+    ++_nb_queued;
+    ++_nb_submitted;
+  }
+  {
+    // Synchronize with threads about to sleep so that none misses
+    // the new task.
+    std::lock_guard<std::mutex> lock(_sleep_mutex);
+  }
+  _wake_up.notify_one();
+  _progress.notify_all();
+}
+
+void task_executor::wait(task_group& group) {
+  auto rank = current_queue();
+  task t;
+  while (group._nb_pending > 0) {
+    std::size_t nb_submitted = _nb_submitted;
+    if (pop_task(rank, t, &group)) {
+      run_task(t);
+      continue;
+    }
+
+    // Remaining tasks from group are running on other threads, sleep
+    // until they are done or they submit subtasks.
+    std::unique_lock<std::mutex> lock(_sleep_mutex);
+    _progress.wait(lock, [&] {
+      return group._nb_pending == 0 or _nb_submitted != nb_submitted;
+    });
+  }
+
+  if (group._exception) {
+    std::rethrow_exception(group._exception);
+  }
+}
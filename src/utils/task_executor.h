@@ -0,0 +1,111 @@
+#ifndef TASK_EXECUTOR_H
+#define TASK_EXECUTOR_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2018, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Set of tasks submitted together and waited for at once.
+class task_group {
+private:
+  friend class task_executor;
+
+  std::atomic<std::size_t> _nb_pending;
+  std::mutex _exception_mutex;
+  std::exception_ptr _exception;
+  // Group of the task that submitted tasks from this group, if any.
+  const task_group* _parent;
+
+  // Whether group is this one or one of its ancestors.
+  bool is_within(const task_group* group) const;
+
+public:
+  task_group();
+
+  task_group(const task_group&) = delete;
+
+  task_group& operator=(const task_group&) = delete;
+};
+
+// Work-stealing pool of threads. Each thread pushes and pops tasks
+// at the back of its own queue and steals from the front of other
+// queues when its own is empty. A thread waiting for a group runs
+// pending tasks from that group or from groups nested in it, so that
+// tasks can submit and wait for subtasks, and only sleeps when none
+// is available.
+class task_executor {
+private:
+  struct task {
+    std::function<void()> run;
+    task_group* group;
+  };
+
+  struct task_queue {
+    std::mutex mutex;
+    std::deque<task> tasks;
+  };
+
+  // Queue 0 is shared by threads outside the pool, next ones are
+  // owned by pool threads.
+  std::vector<std::unique_ptr<task_queue>> _queues;
+  std::vector<std::thread> _threads;
+  std::atomic<std::size_t> _nb_queued;
+  // Total number of submitted tasks, used by waiting threads to
+  // detect new tasks.
+  std::atomic<std::size_t> _nb_submitted;
+  std::mutex _sleep_mutex;
+  // Signalled for pool threads looking for work.
+  std::condition_variable _wake_up;
+  // Signalled for threads waiting for a group, on new tasks and when
+  // a group is done.
+  std::condition_variable _progress;
+  bool _stop;
+
+  std::size_t current_queue() const;
+
+  // Pop a task from queue rank or steal one from another queue,
+  // return false if none is available. Only tasks within group are
+  // considered, unless group is null.
+  bool pop_task(std::size_t rank, task& t, const task_group* group);
+
+  void run_task(task& t);
+
+  void work(std::size_t rank);
+
+public:
+  // Run tasks on nb_threads threads, counting the one waiting.
+  task_executor(unsigned nb_threads);
+
+  task_executor(const task_executor&) = delete;
+
+  task_executor& operator=(const task_executor&) = delete;
+
+  ~task_executor();
+
+  unsigned size() const {
+    return _queues.size();
+  }
+
+  void submit(task_group& group, std::function<void()> run);
+
+  // Run tasks within group until all tasks from group are done, then
+  // rethrow the first exception raised by one of them, if any.
+  void wait(task_group& group);
+};
+
+#endif